@@ -0,0 +1,27 @@
+#include "LD_Benchmark.h"
+#include <iostream>
+#include <string>
+
+// Entry point for the Benchmark build target. Doesn't touch the camera or
+// mirror so can be run on any machine.
+//
+// ld_benchmark [results.csv] [results.json] saves the stage timings as
+// well, to compare with another run.
+int main(int argc, char* argv[]){
+    std::vector<Stage_Result> results;
+    int n_Errors = Benchmark_Suite(results);
+    for (int i=1; i < argc; i++){
+        std::string file_Name = argv[i];
+        if (file_Name.size() > 5 && file_Name.substr(file_Name.size() - 5) == ".json"){
+            Write_Results_JSON(results, file_Name);
+        }
+        else{
+            Write_Results_CSV(results, file_Name);
+        }
+    }
+
+    if (n_Errors > 0){
+        std::cout << n_Errors << " benchmark check(s) failed!" << std::endl;
+    }
+    return n_Errors;
+}
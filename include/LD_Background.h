@@ -0,0 +1,76 @@
+#ifndef LD_BACKGROUND_H
+#define LD_BACKGROUND_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LD_Frame.h"
+
+namespace LD_QuarcTracker{
+
+    // Running estimate of the background (stray light, dark current, the
+    // odd warm pixel) of every pixel of one frame geometry, ie. the full
+    // frame or one AOI, so it can be taken off before thresholding. Each
+    // pixel is an exponential average of the frames it's been given, kept
+    // in fixed point so updating it is just a shift and an add.
+    class Background_Model
+    {
+        public:
+            Background_Model();
+            ~Background_Model();
+
+            // Forget everything and start again for frames the size and
+            // position of my_Frame.
+            int Reset(const LD_Camera::Frame_View& my_Frame);
+
+            // Is it for frames the size and position of my_Frame?
+            bool Same_Geometry(const LD_Camera::Frame_View& my_Frame) const;
+
+            // Has it seen any frames yet? Until it has there's nothing to
+            // subtract.
+            bool Ready() const;
+            uint64_t Num_Updates() const;
+
+            // Fold my_Frame into the average. Each update moves every pixel
+            // 1 / 2^rate_Shift of the way towards the new value. Pixels in the
+            // rectangle skip_X, skip_Y, skip_Width x skip_Height (relative to
+            // the top left of my_Frame, ie. where the spot is) are left alone
+            // so the spot doesn't become part of the background. my_Frame has
+            // to have the same geometry.
+            int Update(const LD_Camera::Frame_View& my_Frame, int rate_Shift,
+                       int skip_X, int skip_Y, int skip_Width, int skip_Height);
+
+            // The background for row of my_Frame, in pixel values, lined up
+            // with the pixels of the row. my_Frame can be a Sub_View of a
+            // frame of this geometry (e.g. the ROI window). nullptr if it
+            // isn't inside this geometry or the model isn't Ready.
+            const uint16_t* Row(const LD_Camera::Frame_View& my_Frame, int row) const;
+
+            // Binary file, a header with the geometry then the averages.
+            // Load fails (and leaves the model alone) if the file is for a
+            // different geometry to the one the model was Reset to.
+            int Save(std::string file_Name) const;
+            int Load(std::string file_Name);
+
+            // Name for the geometry of my_Frame, e.g. "1280x1024+0+0_10bit",
+            // to tell the files (and models) apart.
+            static std::string Geometry_Name(const LD_Camera::Frame_View& my_Frame);
+
+        private:
+            int width = 0;
+            int height = 0;
+            int offset_X = 0;
+            int offset_Y = 0;
+            int bits_Per_Pixel = 0;
+            uint64_t n_Updates = 0;
+
+            // Pixel values << fraction_Bits, the average itself.
+            std::vector<uint32_t> average;
+            // Rounded to whole pixel values, what actually gets subtracted.
+            std::vector<uint16_t> estimate;
+    };
+
+} // namespace LD_QuarcTracker
+
+#endif // LD_BACKGROUND_H
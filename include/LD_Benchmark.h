@@ -0,0 +1,43 @@
+#ifndef LD_BENCHMARK_H
+#define LD_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+// Micro-benchmarks for the image processing kernels. None of these need a
+// camera (or the uEye driver), see benchmark.cpp.
+
+// One stage of the spot finder on one sort of frame, from Benchmark_Suite.
+struct Stage_Result{
+    std::string stage;
+    int width;
+    int height;
+    int bits_Per_Pixel;
+    double sigma;
+    double ns_Per_Frame;
+    // Bytes the stage reads (the frame, or the projections for the
+    // estimators) over the time it takes.
+    double bytes_Per_Second;
+    // RMS distance from the true spot centre, in pixels. -1 for stages
+    // that don't say where the spot is.
+    double centroid_Error;
+};
+
+// Time each stage of the spot finder (unpacking, the projections with and
+// without corrections, the searches, the estimators, the gaussian fit) on
+// synthetic frames (see LD_Synthetic) of spots with random subpixel
+// centres, shot and read noise, a gradient and hot pixels. Full frame and
+// both AOI sizes, 8 and 10 bit, a small spot and a bigger one. The unpack
+// and fused projection stages are run at each SIMD level the CPU has.
+//
+// Checks as it goes: every unpack level matches the scalar one, every
+// projection matches Project_Reference making the same corrections, the
+// searches find the spot, and the estimators and fit aren't too far out.
+// Returns how many checks failed.
+int Benchmark_Suite(std::vector<Stage_Result>& results);
+
+// Benchmark_Suite's results, one line/object per stage, to compare runs.
+int Write_Results_CSV(const std::vector<Stage_Result>& results, std::string file_Name);
+int Write_Results_JSON(const std::vector<Stage_Result>& results, std::string file_Name);
+
+#endif // LD_BENCHMARK_H
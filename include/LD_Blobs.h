@@ -0,0 +1,100 @@
+#ifndef LD_BLOBS_H
+#define LD_BLOBS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LD_Frame.h"
+#include "LD_SpotKernels.h"
+
+// Connected blobs of bright pixels, so that a stray reflection (or a
+// second beacon) in the frame can be told apart from the spot rather than
+// just making the frame look too bright.
+namespace LD_QuarcTracker{
+
+    struct Blob{
+        // Brightness weighted centre, relative to the top left of the
+        // frame it was found in.
+        double x;
+        double y;
+        // Number of pixels, total and brightest pixel value.
+        int area;
+        uint64_t total;
+        uint16_t peak;
+        // Bounding box, inclusive.
+        int min_X;
+        int min_Y;
+        int max_X;
+        int max_Y;
+        // Brightness weighted second moments about (x, y), of the pixels
+        // over the threshold.
+        double var_X;
+        double var_Y;
+        double cov_XY;
+    };
+
+    // Reused from frame to frame so nothing is allocated per frame.
+    struct Blob_Scratch{
+        struct Run{
+            int start;
+            int end;
+            int label;
+        };
+        // Totals for one label, labels which turn out to be part of the same
+        // blob are merged at the end.
+        struct Label{
+            int parent;
+            Blob blob;
+            uint64_t total_X;
+            uint64_t total_Y;
+            uint64_t total_XX;
+            uint64_t total_YY;
+            uint64_t total_XY;
+        };
+
+        std::vector<uint16_t> row_Max;
+        std::vector<Row_Sums> row_Sums;
+        std::vector<uint16_t> line;
+        std::vector<Run> runs;
+        std::vector<Run> last_Runs;
+        std::vector<Label> labels;
+        Pixel_Histogram histogram;
+    };
+
+    // Find every 8-connected blob of pixels brighter than peak_Thresh * the
+    // brightest pixel (and abs_Thresh), or the thresholds from adaptive if
+    // it's enabled. One pass over the frame for the row maxima (the SIMD
+    // row kernel) and then only the rows with something over the threshold
+    // are run length encoded and labelled. Returns the threshold used. The pixels are corrected first, as the projections.
+    // If stats isn't nullptr it's filled in as the projections do it, with
+    // n_Peak_Pixels the pixels in all the blobs.
+    uint16_t Find_Blobs(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                        std::vector<Blob>& blobs, Blob_Scratch& scratch,
+                        const Pixel_Corrections& corrections = Pixel_Corrections(),
+                        Projection_Stats* stats = nullptr,
+                        const Adaptive_Thresh& adaptive = Adaptive_Thresh());
+
+    // How to choose the spot from several blobs.
+    enum Blob_Ranking{
+        // Highest peak pixel.
+        RANK_BRIGHTEST,
+        // Closest to where the spot was last time.
+        RANK_NEAREST,
+        // Area closest to what the spot is expected to be.
+        RANK_AREA
+    };
+
+    // From the name used in the ini file ("brightest", "nearest", "area").
+    // Unknown names give brightest.
+    Blob_Ranking Blob_Ranking_From_Name(std::string name);
+
+    // Index of the best blob with an area from min_Area to max_Area, or -1
+    // if there are none. RANK_NEAREST falls back to the brightest if there
+    // is no last position (have_Last false).
+    int Choose_Blob(const std::vector<Blob>& blobs, Blob_Ranking ranking, int min_Area, int max_Area,
+                    bool have_Last, double last_X, double last_Y, int expected_Area);
+
+} // namespace LD_QuarcTracker
+
+#endif // LD_BLOBS_H
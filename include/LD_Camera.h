@@ -5,6 +5,9 @@
 #include <string>
 #include <vector>
 
+#include "LD_Frame.h"
+#include "LD_PixelMap.h"
+
 // Silence the warnings we can't do anything about.
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
@@ -14,6 +17,11 @@
 namespace LD_Camera{
     int FindCameras();
 
+    // Count a whole frame copied out of the driver memory, by the camera or
+    // anything else handed the frame (the display, telemetry), so
+    // Get_Image_Copies sees them all. Fine from any thread.
+    void Count_Image_Copy();
+
     struct Pixel_Values{
         int x;
         int y;
@@ -41,11 +49,24 @@ namespace LD_Camera{
         Exposure exposure_AOI;
         int bits_Per_Pixel;
         AOI aoi_Dimensions;
+        // Number of image memories in each ring (full frame and AOI) for
+        // the driver to capture into.
+        int n_Buffers;
+        // Let the camera free run so the next frame is exposing while the
+        // current one is processed, rather than triggering each frame.
+        bool continuous_Capture;
+        // Hot/stuck pixel and column offset calibration (see
+        // Calibrate_Pixel_Map), loaded at Init if it exists.
+        std::string pixel_Map_File;
     };
 
     struct Camera_Memory{
         int id;
         char* buffer;
+        // Bytes per line as the driver actually laid it out.
+        int pitch;
+        int width;
+        int height;
     };
 
     class Camera
@@ -101,11 +122,20 @@ namespace LD_Camera{
 
             bool aoi_Set = false;
 
-            // Fill the image buffer with the data from the sensor.
+            // Capture a frame into the next free memory in the ring. Nothing
+            // is copied, the memory is locked so the driver leaves it alone
+            // until the next call to Take_Picture. Returns 1 if there wasn't
+            // a frame, Get_Frame is then invalid (see Frame_View::Valid).
             int Take_Picture();
 
+            // A view of the most recent frame from Take_Picture, straight out
+            // of the driver's memory. Valid until the next Take_Picture (or
+            // AOI change).
+            const Frame_View& Get_Frame();
+
             // Return a linear vector of the pixel values. Calls Take_Picture
             // so anything that relies on the image being in memory still works
+            // Unlike Get_Frame this unpacks (copies) the whole image.
             const std::vector<uint16_t>& Get_Picture();
 
             // Save the most recent result from Take_Picture to file. Either as
@@ -113,14 +143,48 @@ namespace LD_Camera{
             // with 2 bytes per pixel.
             int Save_Picture(std::string filename, bool binary = true);
 
+            // How many times a whole image has been copied out of the driver
+            // memory (see Count_Image_Copy). Should only go up while tracking
+            // if the display or telemetry are taking frames.
+            uint64_t Get_Image_Copies();
+
+            // Take n_Frames full frames (the camera should be covered) and
+            // make a new pixel map from them (see Pixel_Map for hot_Thresh
+            // and stuck_Fraction). Saved to pixel_Map_File and used from
+            // then on. Puts the AOI back afterwards if it was set.
+            int Calibrate_Pixel_Map(int n_Frames, double hot_Thresh, double stuck_Fraction);
+            const Pixel_Map& Get_Pixel_Map();
+            // e.g. for frames that didn't come from this camera.
+            int Set_Pixel_Map(const Pixel_Map& new_Map);
+
         protected:
-            // Nice C++ STL containers for the image data.
+            // Nice C++ STL containers for the image data. Only filled on
+            // request (Get_Picture/Save_Picture), not every frame.
             std::vector<uint16_t> full_Image_Data;
             std::vector<uint16_t> aoi_Image_Data;
 
+            // Unpack the pixels of a frame into a vector container.
+            int Copy_Memory(const Frame_View &my_Frame, std::vector<uint16_t> &my_Dest_Vector);
+
         private:
-            // Move from the image buffer into the vector container.
-            int Copy_Memory(Camera_Memory &my_Buffer, std::vector<uint16_t> &my_Dest_Vector);
+            // Allocate/free a ring of image memories of the given size.
+            int Alloc_Ring(std::vector<Camera_Memory> &my_Ring, int width, int height);
+            int Free_Ring(std::vector<Camera_Memory> &my_Ring);
+            // Make the driver capture into this ring.
+            int Activate_Ring(std::vector<Camera_Memory> &my_Ring);
+            // Give the locked memory of the current frame back to the driver.
+            int Release_Frame();
+            // The memory in the active ring the driver most recently finished
+            // writing (nullptr on failure).
+            Camera_Memory* Newest_Memory();
+            // In continuous mode, wait until the driver has finished a frame
+            // that hasn't been handed out yet, and return the newest one.
+            Camera_Memory* Wait_For_New_Frame();
+            int Wait_For_Frame_Event();
+            // Start/stop the free running capture in continuous mode. The
+            // capture has to be stopped to change AOI or image memories.
+            int Start_Capture();
+            int Stop_Capture();
 
             // Save the vector as a CSV, insert a line break every line_Length.
             int To_CSV(std::vector<uint16_t> &image_Vector, std::string file_Name, int line_Length);
@@ -146,9 +210,32 @@ namespace LD_Camera{
             // but some things will need to know the exact number.
             int m_nBitsPerPixel;
 
-            // Contains arrays for the camera API to dump image data into.
-            Camera_Memory frame_Memory;
-            Camera_Memory aoi_Memory;
+            // Rings of arrays for the camera API to dump image data into, the
+            // driver cycles through them so the last frame can be read while
+            // the next one is captured.
+            int n_Buffers;
+            std::vector<Camera_Memory> frame_Ring;
+            std::vector<Camera_Memory> aoi_Ring;
+            // The memory holding the current frame, locked while we use it.
+            char* locked_Buffer = nullptr;
+            // What Get_Frame hands out.
+            Frame_View current_Frame;
+            uint64_t frame_Counter = 0;
+            // Calibration of the sensor's bad pixels, and where it's kept.
+            Pixel_Map pixel_Map;
+            std::string pixel_Map_File;
+
+            bool continuous_Capture = false;
+            bool capture_Running = false;
+            // The camera's own count of the last frame handed out, so the
+            // same frame isn't handed out twice in continuous mode.
+            uint64_t last_Frame_Number = 0;
+            // And the camera's timestamp for it, in 0.1us.
+            uint64_t last_Frame_Timestamp = 0;
+            #ifdef _WIN32
+            // Windows signals new frames through an event handle.
+            HANDLE frame_Event;
+            #endif // _WIN32
 
             // Default objects are the ones set in options passed to Init()
             Exposure default_Exposure;
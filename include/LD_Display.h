@@ -0,0 +1,143 @@
+#ifndef LD_DISPLAY_H
+#define LD_DISPLAY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "LD_Camera.h"
+#include "LD_Frame.h"
+// For HAVE_OPENCV and the opencv headers.
+#include "LD_TrackerCamera.h"
+
+// How the display draws the frames.
+struct Display_Options{
+    // Most frames a second to draw (0 = every frame the display thread can
+    // keep up with).
+    double max_Rate = 30;
+    // Pixel values drawn black and white, anything outside is clipped. A
+    // white_Level of 0 means the top of the camera's range.
+    int black_Level = 0;
+    int white_Level = 0;
+    // Brightness goes as (value - black)^(1/gamma) in between, so > 1
+    // brings out faint things.
+    double gamma = 1;
+    // Only show every decimation'th pixel and row of full frames. The AOI
+    // is always shown in full.
+    int decimation = 1;
+};
+
+#ifdef HAVE_OPENCV
+// Everything the display draws on top of the frame. Taken at the same time
+// as the frame so the two always agree.
+struct Display_Overlay{
+    // display modes:
+    //  0: just show the image.
+    //  1: draw a circle around the detected spot
+    //  2: also draw a circle at the set point
+    //  3: also draw a rectagle at the AOI (if not set)
+    int display_Mode = 0;
+    bool spot_Found = false;
+    // Both relative to the top left of the frame, like the tracker has
+    // them.
+    LD_Camera::Subpixel_Values spot_Coords = {0, 0};
+    LD_Camera::Pixel_Values setpoint = {0, 0};
+    bool aoi_Set = false;
+    // Where the AOI is on the sensor (only drawn when it isn't set).
+    LD_Camera::AOI aoi = {};
+};
+
+// Shows the camera feed in an opencv window on its own thread, so the
+// tracker loop never waits for imshow/waitKey. The loop hands over frames
+// with Post_Frame and picks up key presses with Next_Key, neither of which
+// ever blocks.
+//
+// Frames go through a triple buffer: the loop fills one slot, the display
+// thread draws another and the third sits in between holding the newest
+// frame. Swapping slots is a single atomic exchange either side, and a
+// frame the display didn't get round to is just replaced by the next one.
+class LD_Display
+{
+    public:
+        LD_Display();
+        ~LD_Display();
+
+        // Open the window and start drawing frames as options says. Does
+        // nothing if it's already running.
+        int Start(const Display_Options& options);
+        // Stop the thread. The window stays until the next waitKey.
+        int Stop();
+
+        // Copy my_Frame for the display thread if it's due another frame,
+        // otherwise return straight away. The copy is needed since the
+        // camera reuses the memory as soon as the next picture is taken.
+        // Full frames are decimated as they're copied.
+        int Post_Frame(const LD_Camera::Frame_View& my_Frame, const Display_Overlay& overlay);
+
+        // The oldest key pressed in the window that hasn't been picked up
+        // yet, in kb_Hit. False if there aren't any.
+        bool Next_Key(int& kb_Hit);
+
+    private:
+        struct Display_Slot{
+            // The frame's rows, packed with no padding.
+            std::vector<uint8_t> pixels;
+            // Pointing at pixels. Smaller than the camera's frame by
+            // decimation.
+            LD_Camera::Frame_View frame;
+            int decimation = 1;
+            Display_Overlay overlay;
+        };
+
+        void Display_Loop();
+        int Draw_Slot(const Display_Slot& slot);
+
+        // (Re)make lut for frames of bits_Per_Pixel.
+        int Make_LUT(int bits_Per_Pixel);
+        // Put the frame in myMat through the lut, grey in all three colours
+        // so the overlays can go on top in colour. myMat is reused from
+        // frame to frame.
+        int Make_Opencv_Mat(const LD_Camera::Frame_View& my_Frame);
+        // Draw features on myMat, used to draw spots at the set point and
+        // tracked spot position, and a rectangle around the AOI. In
+        // camera pixels, scaled down by decimation.
+        int Draw_Spot(LD_Camera::Subpixel_Values spot_Position, int decimation, cv::Scalar colour);
+        int Draw_AOI(LD_Camera::AOI my_AOI, int decimation);
+
+        Display_Options options;
+
+        std::array<Display_Slot, 3> slots;
+        // Slot the loop fills next (only touched by the loop).
+        int post_Slot = 0;
+        // Slot being drawn (only touched by the display thread).
+        int draw_Slot = 1;
+        // Slot in between, with fresh_Frame set if the loop has put a
+        // frame in it that the display hasn't taken yet.
+        static const int fresh_Frame = 4;
+        std::atomic<int> middle_Slot;
+
+        // Keys from the display thread to the loop. Single producer, single
+        // consumer, so two counters are enough. Keys are dropped if the loop
+        // stops picking them up.
+        std::array<int, 64> keys;
+        std::atomic<uint64_t> keys_Written;
+        std::atomic<uint64_t> keys_Read;
+
+        std::chrono::steady_clock::duration frame_Period;
+        std::chrono::steady_clock::time_point next_Post;
+
+        std::atomic<bool> stopping;
+        std::thread display_Thread;
+
+        // Grey level for every pixel value, contrast and gamma included.
+        std::vector<uint8_t> lut;
+        int lut_Bits = 0;
+
+        cv::Mat myMat;
+};
+#endif // HAVE_OPENCV
+
+#endif // LD_DISPLAY_H
@@ -0,0 +1,34 @@
+#ifndef LD_ESTIMATORS_H
+#define LD_ESTIMATORS_H
+
+#include <cstdint>
+#include <vector>
+
+// Ways of getting the centre of the spot to subpixel accuracy from one of
+// its projections (row_Totals or col_Totals). All of them give the position
+// in bins from the start of the projection, and the peak bin if there's
+// nothing better to go on (peak at the very edge, nothing in it...)
+namespace LD_QuarcTracker{
+
+    // Centroid of every bin over thresh_Fraction of the biggest. Walks the
+    // whole projection.
+    float Thresholded_Centroid(const std::vector<uint64_t>& distribution, double thresh_Fraction);
+
+    // Centroid of the bins no more than half_Width from the biggest. Only
+    // looks at 2*half_Width+1 bins once the peak is found, so isn't bothered
+    // by anything else bright further along, but half_Width wants to be
+    // about 3 spot sigmas or it's pulled towards the middle of the peak bin.
+    float Windowed_Centroid(const std::vector<uint64_t>& distribution, int half_Width);
+
+    // Vertex of the parabola through the biggest bin and the ones either
+    // side. Cheap, but biased towards the middle of the peak bin unless the
+    // spot is a few pixels wide.
+    float Parabolic_Peak(const std::vector<uint64_t>& distribution);
+
+    // Same, through the logs of the three bins, which is exact for a
+    // gaussian. Falls back to Parabolic_Peak if a neighbour is empty.
+    float Gaussian_Peak(const std::vector<uint64_t>& distribution);
+
+} // namespace LD_QuarcTracker
+
+#endif // LD_ESTIMATORS_H
@@ -0,0 +1,92 @@
+#ifndef LD_FRAME_H
+#define LD_FRAME_H
+
+#include <cstdint>
+
+namespace LD_Camera{
+
+    // A read-only look at one image sitting in memory that somebody else
+    // owns (the uEye driver, or the replay backend). Nothing is copied so
+    // the view is only good until the owner hands out another frame.
+    //
+    // Pixels are laid out exactly as the driver writes them: one byte per
+    // pixel for MONO8, or a little endian uint16_t per pixel for MONO16 with
+    // the data in the top bits_Per_Pixel bits (hence Shift()).
+    struct Frame_View{
+        const uint8_t* data = nullptr;
+        int width = 0;
+        int height = 0;
+        // Bytes from the start of one row to the start of the next. Can be
+        // more than width * Bytes_Per_Pixel() if the driver pads the lines.
+        int stride = 0;
+        // Where the top left of this image sits on the sensor (non zero for
+        // an AOI, or for a Sub_View of another frame).
+        int offset_X = 0;
+        int offset_Y = 0;
+        int bits_Per_Pixel = 8;
+        // Counts up by one for every frame handed out.
+        uint64_t frame_ID = 0;
+        // When it was captured, in seconds. Only the differences between
+        // frames mean anything (it's the camera's clock if it has one).
+        double capture_Time = 0;
+
+        bool Valid() const{
+            return (data != nullptr) && (width > 0) && (height > 0);
+        }
+
+        int Bytes_Per_Pixel() const{
+            return (bits_Per_Pixel > 8) ? 2 : 1;
+        }
+
+        // How far right a raw MONO16 value needs shifting to get the pixel
+        // value. Always 0 for MONO8.
+        int Shift() const{
+            return (bits_Per_Pixel > 8) ? (16 - bits_Per_Pixel) : 0;
+        }
+
+        int Num_Pixels() const{
+            return width * height;
+        }
+
+        const uint8_t* Row(int y) const{
+            return data + (y * stride);
+        }
+
+        // Convenient but slow, don't use this in a loop over the frame.
+        uint16_t Pixel(int x, int y) const{
+            const uint8_t* row = Row(y);
+            if (bits_Per_Pixel > 8){
+                uint16_t raw = row[2*x] + (row[2*x + 1] << 8);
+                return raw >> Shift();
+            }
+            else{
+                return row[x];
+            }
+        }
+
+        // A view of a rectangle inside this one. Same memory, just a
+        // different start pointer and size. The rectangle is clipped to fit.
+        Frame_View Sub_View(int x, int y, int w, int h) const{
+            if (x < 0){ w += x; x = 0; }
+            if (y < 0){ h += y; y = 0; }
+            if (x + w > width){ w = width - x; }
+            if (y + h > height){ h = height - y; }
+
+            Frame_View sub = *this;
+            if ((w <= 0) || (h <= 0)){
+                sub.width = 0;
+                sub.height = 0;
+                return sub;
+            }
+            sub.data = Row(y) + (x * Bytes_Per_Pixel());
+            sub.width = w;
+            sub.height = h;
+            sub.offset_X = offset_X + x;
+            sub.offset_Y = offset_Y + y;
+            return sub;
+        }
+    };
+
+} // namespace LD_Camera
+
+#endif // LD_FRAME_H
@@ -0,0 +1,66 @@
+#ifndef LD_GAUSSFIT_H
+#define LD_GAUSSFIT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "LD_Frame.h"
+
+// Least squares fit of a 2D gaussian to a small window of pixels, as a
+// more accurate (and more expensive) alternative to the thresholded
+// centroid of the projections.
+namespace LD_QuarcTracker{
+
+    // amplitude * exp(-(x-x0)^2/(2 sigma_X^2) - (y-y0)^2/(2 sigma_Y^2)) + offset
+    // Positions are in pixels from the top left of the window fitted.
+    struct Gauss_Params{
+        double amplitude;
+        double x0;
+        double y0;
+        double sigma_X;
+        double sigma_Y;
+        double offset;
+    };
+
+    struct Gauss_Fit_Result{
+        Gauss_Params params;
+        // RMS difference between the pixels and the fitted gaussian.
+        double residual;
+        int iterations;
+        // False if it ran out of iterations, or got stuck where no step
+        // (however small) made it any better.
+        bool converged;
+    };
+
+    // Reused from fit to fit so nothing is allocated per frame.
+    struct Gauss_Fit_Scratch{
+        std::vector<uint16_t> line;
+        std::vector<double> pixels;
+        // The x and y parts of the gaussian and its derivatives (see
+        // LD_GaussFit.cpp) and the pixels dotted with the x parts.
+        std::vector<double> x_Terms;
+        std::vector<double> y_Terms;
+        std::vector<double> row_Dots;
+    };
+
+    // Guess the parameters from the pixels (offset from the dimmest pixel,
+    // amplitude from the brightest, sigma from how many are over half way)
+    // with the centre at seed_X, seed_Y.
+    Gauss_Params Seed_Gaussian(const LD_Camera::Frame_View& window, double seed_X, double seed_Y,
+                               Gauss_Fit_Scratch& scratch);
+
+    // Levenberg-Marquardt fit of the gaussian to every pixel in window,
+    // starting from seed. Stops after max_Iterations or when an iteration
+    // improves the squared error by less than a part in 10^6.
+    Gauss_Fit_Result Fit_Gaussian(const LD_Camera::Frame_View& window, Gauss_Params seed,
+                                  int max_Iterations, Gauss_Fit_Scratch& scratch);
+
+    // Whether fit found the spot it was seeded on rather than wandering
+    // off: still a bright spot, centre no more than 2 sigma from the seed's
+    // and an rms residual under a tenth of the amplitude. Not converging
+    // within max_Iterations doesn't count against it.
+    bool Fit_Believable(const Gauss_Fit_Result& fit, const Gauss_Params& seed);
+
+} // namespace LD_QuarcTracker
+
+#endif // LD_GAUSSFIT_H
@@ -0,0 +1,56 @@
+#ifndef LD_HISTOGRAM_H
+#define LD_HISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+// Histograms of pixel values, filled a row at a time by Row_Histogram (see
+// LD_RowKernels) as the spot finder sweeps the frame, for picking the
+// thresholds from.
+namespace LD_QuarcTracker{
+
+    // 10 bits worth of bins, deeper pixels share them.
+    const int histogram_Bins = 1024;
+    // Neighbouring pixels are counted in different copies of the histogram,
+    // otherwise a run of pixels in the same bin (most of the background)
+    // has every increment waiting for the one before to be stored.
+    const int histogram_Banks = 4;
+    // Banks start this far apart. Not exactly 4kB, or the CPU mistakes a
+    // count in one bank for depending on the last count in the one before.
+    const int histogram_Bank_Stride = histogram_Bins + 16;
+
+    struct Pixel_Histogram{
+        // histogram_Banks lots of histogram_Bins counts, one bank every
+        // histogram_Bank_Stride. What Row_Histogram fills.
+        std::vector<uint32_t> banks;
+        // The banks added up, by Finish_Histogram.
+        std::vector<uint32_t> counts;
+        uint64_t n_Pixels;
+        // A pixel value goes in bin (value >> bin_Shift).
+        int bin_Shift;
+        // Bins the pixels can reach, fewer than histogram_Bins for 8 bit
+        // pixels. Only these are cleared and added up each frame.
+        int n_Bins;
+    };
+
+    // Empty it, ready for pixels of bits_Per_Pixel.
+    int Reset_Histogram(Pixel_Histogram& histogram, int bits_Per_Pixel);
+
+    // Count one pixel value, for the odd pixel Row_Histogram doesn't see
+    // (e.g. a replaced bad pixel).
+    void Add_Pixel(Pixel_Histogram& histogram, uint16_t pixel);
+
+    // Add the banks of other (another thread's share of the frame, say) to
+    // histogram. Both have to be for the same pixel depth.
+    int Merge_Histogram(Pixel_Histogram& histogram, const Pixel_Histogram& other);
+
+    // Add up the banks into counts. Needed before Percentile.
+    int Finish_Histogram(Pixel_Histogram& histogram);
+
+    // The pixel value (the bottom of its bin) that fraction of the pixels
+    // are at or below. 0 if there are no pixels.
+    uint16_t Percentile(const Pixel_Histogram& histogram, double fraction);
+
+} // namespace LD_QuarcTracker
+
+#endif // LD_HISTOGRAM_H
@@ -0,0 +1,81 @@
+#ifndef LD_INTEGRAL_H
+#define LD_INTEGRAL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "LD_Frame.h"
+#include "LD_SpotKernels.h"
+
+namespace LD_QuarcTracker{
+
+    // What's inside one rectangle of an Integral_Image.
+    struct Window_Moments{
+        // Sum of the pixels (less the floor).
+        uint64_t total;
+        // Their centroid, in pixels of the frame. -1 if total is 0.
+        double x;
+        double y;
+    };
+
+    // Summed-area table of the pixels of one frame. Built in one pass,
+    // after which the total of any rectangle comes from four corners of the
+    // table, however big it is, so lots of candidate windows can be tried
+    // without reading the pixels again.
+    //
+    // There are no tables of the pixels * x and * y for the centroids:
+    // they're 64 bit, so they'd be 5 times the memory traffic of the one
+    // table, and only one or two windows a frame want a centroid. Those are
+    // worked out from the pixels instead.
+    class Integral_Image
+    {
+        public:
+            Integral_Image();
+            ~Integral_Image();
+
+            // Make the table for my_Frame, with the corrections applied.
+            // Pixels at or below floor count as 0 and the rest have floor
+            // taken off, so a flat background doesn't drag the centroids to
+            // the middle of the window. my_Frame's pixels (and the
+            // corrections) have to stay put until the last call to Window.
+            int Build(const LD_Camera::Frame_View& my_Frame, uint16_t floor,
+                      const Pixel_Corrections& corrections = Pixel_Corrections());
+
+            bool Valid() const;
+            int Width() const;
+            int Height() const;
+
+            // Total and centroid of the rectangle with its top left at x, y,
+            // clipped to the frame. Window reads the rectangle's pixels to
+            // get the centroid, Window_Total only needs the table. Exact as
+            // long as the total is less than 2^32 (any window of a 10 bit
+            // frame up to 4 Mpixels).
+            Window_Moments Window(int x, int y, int width, int height);
+            uint64_t Window_Total(int x, int y, int width, int height) const;
+
+            // Slide a width x height window over the frame step pixels at a
+            // time and find the one with the most in it. x and y are its top
+            // left. Returns the total (0 if there's nothing brighter than
+            // the floor anywhere).
+            uint64_t Brightest_Window(int width, int height, int step, int& x, int& y) const;
+
+        private:
+            // Clip a rectangle to the frame, as corners of the table.
+            void Clip(int x, int y, int width, int height, int& left, int& top, int& right, int& bottom) const;
+
+            int width = 0;
+            int height = 0;
+            // What the table was made from, for Window.
+            LD_Camera::Frame_View frame;
+            uint16_t frame_Floor = 0;
+            Pixel_Corrections frame_Corrections = Pixel_Corrections();
+            // width + 1 by height + 1, the first row and column are 0 so the
+            // corners never need checking.
+            std::vector<uint32_t> sums_I;
+            // One line of corrected pixels.
+            std::vector<uint16_t> line;
+    };
+
+} // namespace LD_QuarcTracker
+
+#endif // LD_INTEGRAL_H
@@ -1,45 +1,65 @@
 #ifndef LD_PID_H
 #define LD_PID_H
 
-#include <chrono>
-
+// Gains are per pixel of error and in real time, so the same numbers do
+// the same thing whatever the frame rate:
+//  P: output per pixel of error.
+//  I: output per pixel of error per second.
+//  D: output per pixel per second the spot is moving.
 struct PIDParams{
     float P;
     float I;
     float D;
-    bool constant_Time;
+    // Time constant (seconds) of the low pass filter on the derivative,
+    // which is otherwise mostly spot finder noise. 0 for no filter.
+    float D_Filter_Time;
+    // The output is clipped to this range, and the integral stops growing
+    // once it's clipped (anti windup).
     float max_Output;
     float min_Output;
-
 };
 
+// Position form PID, the output is where to put the mirror rather than
+// how far to move it.
 class PIDLoop {
 private:
-	float k_P;
-	float k_I;
-	float k_D;
-	float error_Last;
-	//let's try it a different way...
-	float proportional;
-	float integral;
-	float derivative;
-	bool first_Loop;
-	float max_Output;
-	float min_Output;
-    std::chrono::time_point<std::chrono::steady_clock> Timer1;
-	std::chrono::time_point<std::chrono::steady_clock> Timer2;
-	//std::chrono::duration<float, std::milli> TimeInterval;
-	bool constant_PID_Time;
-	float time_Interval;
+    double k_P;
+    double k_I;
+    double k_D;
+    double d_Filter_Time;
+    double max_Output;
+    double min_Output;
+
+    double proportional;
+    // Already multiplied by k_I, so changing the gains doesn't make the
+    // output jump.
+    double integral;
+    double derivative;
+    // Filtered rate of change of the measurement.
+    double measurement_Rate;
+    double measurement_Last;
+    double time_Last;
+    // Nothing to take a time difference/derivative from yet.
+    bool first_Loop;
 
 public:
-	PIDLoop();
-	PIDLoop(PIDParams my_Options);
-	~PIDLoop();
-	int InitPID(PIDParams my_Options);
-	float UpdatePID(float error);
-	int ChangePID(float myK_p, float myK_i, float myK_d);
-    int ResetPID();
+    PIDLoop();
+    PIDLoop(PIDParams my_Options);
+    ~PIDLoop();
+    int InitPID(PIDParams my_Options);
+    // error = measurement - set point. The derivative is of the measurement
+    // rather than the error, so moving the set point doesn't kick the
+    // output. time is in seconds, from any clock, ideally when the frame
+    // was captured.
+    float UpdatePID(float error, float measurement, double time);
+    int ChangePID(float myK_p, float myK_i, float myK_d);
+    // New gains/filter/limits, carrying on from the same output. Forgets the
+    // last measurement, use this when the measurement's co-ordinates
+    // change (e.g. switching to the AOI).
+    int ChangePID(PIDParams my_Options);
+    // Start again from output (e.g. wherever the mirror was moved to while
+    // the loop wasn't running).
+    int ResetPID(float output = 0);
 };
 
 struct XY_PID{
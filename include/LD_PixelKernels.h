@@ -0,0 +1,27 @@
+#ifndef LD_PIXELKERNELS_H
+#define LD_PIXELKERNELS_H
+
+#include <cstdint>
+
+#include "LD_Simd.h"
+
+namespace LD_Camera{
+
+    // Turn one line of raw MONO16 driver data (little endian, pixel value in
+    // the top bits) into pixel values, ie. dest[i] = source[i] >> shift.
+    void Unpack_Mono16(const uint8_t* source, uint16_t* dest, int n_Pixels, int shift);
+
+    // Widen one line of MONO8 driver data to uint16_t.
+    void Unpack_Mono8(const uint8_t* source, uint16_t* dest, int n_Pixels);
+
+    // As above but using a specific implementation rather than the best
+    // available. For the benchmark, normal code should use the above. The
+    // CPU had better support the level asked for (see LD_Simd).
+    void Unpack_Mono16(const uint8_t* source, uint16_t* dest, int n_Pixels, int shift,
+                       LD_Simd::Simd_Level level);
+    void Unpack_Mono8(const uint8_t* source, uint16_t* dest, int n_Pixels,
+                      LD_Simd::Simd_Level level);
+
+} // namespace LD_Camera
+
+#endif // LD_PIXELKERNELS_H
@@ -0,0 +1,83 @@
+#ifndef LD_PIXELMAP_H
+#define LD_PIXELMAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LD_Frame.h"
+
+namespace LD_Camera{
+
+    // The bad pixels of one row of a frame, in order. Columns in the frame
+    // are *it - offset.
+    struct Bad_Columns{
+        const uint16_t* first;
+        const uint16_t* last;
+        int offset;
+
+        bool Empty() const{
+            return first == last;
+        }
+    };
+
+    // Calibration of the sensor's fixed faults: hot pixels (always bright),
+    // stuck pixels (never change, which includes dead ones) and the offset
+    // of each column. One map covers the whole sensor, AOI frames are
+    // looked up by their offsets. The bad pixels are kept as a sorted list
+    // of columns for each row rather than a mask the size of the frame, so
+    // most rows have nothing to look at at all.
+    class Pixel_Map
+    {
+        public:
+            Pixel_Map();
+            ~Pixel_Map();
+
+            // Calibration. Start with a full frame, add n frames taken with
+            // the camera covered (or at least without the spot), then Finish.
+            int Start_Calibration(const Frame_View& my_Frame);
+            int Add_Calibration_Frame(const Frame_View& my_Frame);
+            // A pixel is hot if its average is more than hot_Thresh (pixel
+            // values) over the rest of its column, and stuck if its noise is
+            // less than stuck_Fraction of the typical pixel's. Column offsets
+            // are each column's median level over the darkest column's.
+            int Finish_Calibration(double hot_Thresh, double stuck_Fraction);
+
+            bool Empty() const;
+            int Num_Bad_Pixels() const;
+
+            // The bad pixels in row of my_Frame (which can be an AOI or a
+            // Sub_View of one).
+            Bad_Columns Bad_In_Row(const Frame_View& my_Frame, int row) const;
+            bool Is_Bad(const Frame_View& my_Frame, int x, int y) const;
+
+            // Offsets to take off each column of my_Frame, in pixel values.
+            // nullptr if there aren't any (or they were calibrated at a
+            // different bit depth).
+            const uint16_t* Column_Offsets(const Frame_View& my_Frame) const;
+
+            // Binary file, the sensor size then the lists.
+            int Save(std::string file_Name) const;
+            int Load(std::string file_Name);
+
+        private:
+            int width = 0;
+            int height = 0;
+            int bits_Per_Pixel = 0;
+
+            // Bad columns of sensor row y are bad_Cols[row_Start[y]] up to
+            // bad_Cols[row_Start[y + 1]].
+            std::vector<uint32_t> row_Start;
+            std::vector<uint16_t> bad_Cols;
+            // Empty if every column is the same.
+            std::vector<uint16_t> column_Offsets;
+
+            // Running totals while calibrating.
+            std::vector<uint32_t> sums;
+            std::vector<uint64_t> sum_Squares;
+            int n_Calibration_Frames = 0;
+    };
+
+} // namespace LD_Camera
+
+#endif // LD_PIXELMAP_H
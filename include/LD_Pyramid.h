@@ -0,0 +1,37 @@
+#ifndef LD_PYRAMID_H
+#define LD_PYRAMID_H
+
+#include <cstdint>
+#include <vector>
+
+#include "LD_Frame.h"
+
+// Coarse search for the spot. Shrink the frame by summing blocks of
+// pixels, find the brightest block on the small image, then only the
+// full resolution pixels around it need looking at properly.
+namespace LD_QuarcTracker{
+
+    // The frame shrunk by factor in both directions, each pixel is the sum
+    // of a factor x factor block of the original.
+    struct Pyramid_Image{
+        int factor = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> sums;
+    };
+
+    // Biggest block Build_Pyramid will do. Any coarser and a small spot
+    // would be lost in the background anyway.
+    const int max_Pyramid_Factor = 16;
+
+    // Shrink my_Frame into small_Image. Blocks that would hang off the right
+    // or bottom of the frame are left out. Returns 1 if factor is silly.
+    int Build_Pyramid(const LD_Camera::Frame_View& my_Frame, int factor, Pyramid_Image& small_Image);
+
+    // Centre of the brightest block, in pixels of the frame the image was
+    // made from. False if the image is empty.
+    bool Brightest_Block(const Pyramid_Image& small_Image, int& x, int& y);
+
+} // namespace LD_QuarcTracker
+
+#endif // LD_PYRAMID_H
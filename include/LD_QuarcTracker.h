@@ -2,10 +2,12 @@
 #define LD_QUARCTRACKER_H
 
 #include "LD_Camera.h"
+#include "LD_Display.h"
 #include "LD_TrackerCamera.h"
 #include "LD_MemsMirror.h"
 #include "LD_Util.h"
 #include "LD_Pid.h"
+#include "LD_Telemetry.h"
 #include "LD_Timer.h"
 
 #include <list>
@@ -25,6 +27,11 @@ namespace LD_QuarcTracker{
         // Ignored if 0;
         int tracker_Period;
 
+        // Pixel map calibration ('c' key, see LD_Camera::Pixel_Map).
+        int pixel_Map_Frames;
+        double hot_Pixel_Thresh;
+        double stuck_Pixel_Fraction;
+
         LD_QuarcTracker::SpotFinderOptions full_Spot_Finder;
         LD_QuarcTracker::SpotFinderOptions aoi_Spot_Finder;
 
@@ -36,6 +43,13 @@ namespace LD_QuarcTracker{
         PIDParams aoi_PID_Options;
 
         int display_Mode;
+        // Rate, contrast etc of the opencv window.
+        Display_Options display_Options;
+
+        // Shared memory segment to publish every step to (see
+        // LD_Telemetry), none if empty, and how many steps it holds.
+        std::string telemetry_Name;
+        int telemetry_Slots;
     };
 
     struct APTOutput{
@@ -52,6 +66,34 @@ namespace LD_QuarcTracker{
         int time_Camera;
         int time_Mirror;
         int time_Loop;
+        // Whole images copied during this step (should be 0 while tracking)
+        int image_Copies;
+        // 1 if the spot finder's predicted threshold was off and it had to
+        // project the frame again (the rescan rate is the mean of this).
+        int threshold_Rescans;
+        // How the gaussian fit went, if the spot estimator is gauss_fit.
+        // RMS difference between the pixels and the gaussian, and how many
+        // iterations it took (0 if it wasn't run).
+        float fit_Residual;
+        int fit_Iterations;
+        // Blobs of bright pixels seen, if blob_Detection is on.
+        int n_Blobs;
+        // How the spot looked (see Spot_Result), to tune the exposure and
+        // thresholds from.
+        Spot_Failure spot_Failure;
+        uint16_t spot_Peak;
+        int n_Saturated;
+        float spot_SNR;
+        float spot_Background;
+        float spot_Width_X;
+        float spot_Width_Y;
+        float spot_Ellipticity;
+        // What the pixels had to beat this step, and the noise floor part
+        // of it (moves with the background if adaptive_Thresh).
+        uint16_t spot_Threshold;
+        uint16_t noise_Floor;
+        // Bytes of the frame the spot finder read (see Spot_Result).
+        uint64_t bytes_Read;
     };
 
     struct APTOptions{
@@ -96,6 +138,10 @@ namespace LD_QuarcTracker{
             int Keyboard_Handler(int kb_Hit);
             int Keyboard_Mirror(int kb_Hit);
 
+            // Every step, put the state of the tracker (and the frame if
+            // anyone's watching) in shared memory, if enabled.
+            int Publish_Telemetry(uint64_t step_Number);
+
             // Every step, add a line of tracker output data to a list.
             int Fill_DataList(uint64_t step_Number);
             // Save the tracker output data to a file. Do this after the loop
@@ -131,6 +177,10 @@ namespace LD_QuarcTracker{
             // into a PID_2D class?)
             PIDLoop pid_X;
             PIDLoop pid_Y;
+            // Whether the PIDs are in charge of the mirror. If not (tracker off
+            // or spot lost) they start again from the mirror position next
+            // time.
+            bool pid_Running = false;
 
             // Track the position of the mirror.
             float mirror_X = 0;
@@ -145,6 +195,8 @@ namespace LD_QuarcTracker{
             bool use_AOI;
             // Did the spot detector find a spot last time it ran?
             bool spot_Found = false;
+            // And everything else it had to say about the frame.
+            Spot_Result spot_Result = Spot_Result();
             int no_Spot_Counter = 0;
             // Is the spot inside the AOI? Updated every loop
             bool spot_Inside_AOI = false;
@@ -157,15 +209,29 @@ namespace LD_QuarcTracker{
             // the tracking (by giving you something to compare it to.
             // (Doesn't do anything if =0)
             int tracker_Period;
+            // Pixel map calibration settings, see TrackerOptions.
+            int pixel_Map_Frames;
+            double hot_Pixel_Thresh;
+            double stuck_Pixel_Fraction;
             // display modes:
             //  0: just show the image.
             //  1: draw a circle around the detected spot
             //  2: also draw a circle at the set point
             //  3: also draw a rectagle at the AOI (if not set)
             int display_Mode;
+            Display_Options display_Options;
             // OpenCV window (if enabled) logs keypresses, we can use these for
             // a poor man's UI for now.
             int kb_Hit;
+            // For other programs to watch the tracker.
+            LD_Telemetry my_Telemetry;
+            #ifdef HAVE_OPENCV
+            // The window, drawn on its own thread so the tracker never waits
+            // for it. Key presses come back from it through Next_Key.
+            LD_Display my_Display;
+            // Hand the display the current frame and what to draw on it.
+            int Post_Display();
+            #endif // HAVE_OPENCV
 
             // Threshold distance from the set point that should (if enabled)
             // activate the camera AOI.
@@ -187,6 +253,11 @@ namespace LD_QuarcTracker{
             LD_Timer timer_Camera;
             LD_Timer timer_Mirror;
 
+            // Camera's image copy count at the end of the last step.
+            uint64_t last_Image_Copies = 0;
+            // And the spot finder's rescan count.
+            uint64_t last_Threshold_Rescans = 0;
+
     };
 } // namespace LD_QuarcTracker
 
@@ -0,0 +1,57 @@
+#ifndef LD_REPLAY_H
+#define LD_REPLAY_H
+
+#include <string>
+#include <vector>
+
+#include "LD_Frame.h"
+
+namespace LD_Camera{
+
+    // Plays back frames saved by Camera::Save_Picture (binary .dat, 2 bytes
+    // per pixel, most significant byte first) through the same Frame_View
+    // the camera hands out. Means the spot finder etc. can be run without a
+    // camera attached (and doesn't need the uEye driver at all).
+    class Frame_Replay
+    {
+        public:
+            Frame_Replay();
+            ~Frame_Replay();
+
+            // Load one .dat file as the next frame in the sequence. All the
+            // frames are assumed to be the size given.
+            int Add_Frame(std::string file_Name, int width, int height, int bits_Per_Pixel,
+                          int offset_X = 0, int offset_Y = 0);
+
+            // Add a frame from pixel values already in memory (one value per
+            // pixel, row by row, like Camera::Get_Picture).
+            int Add_Frame(const std::vector<uint16_t> &pixels, int width, int height, int bits_Per_Pixel,
+                          int offset_X = 0, int offset_Y = 0);
+
+            int Num_Frames();
+
+            // Move on to the next recorded frame (wraps back to the first at
+            // the end) and return a view of it.
+            const Frame_View& Next_Frame();
+
+            // The current frame, without moving on.
+            const Frame_View& Get_Frame();
+
+        private:
+            // Frames are stored in the same layout the driver uses (see
+            // Frame_View) so views of them are indistinguishable from the
+            // real thing.
+            struct Replay_Frame{
+                std::vector<uint8_t> buffer;
+                Frame_View view;
+            };
+
+            std::vector<Replay_Frame> frames;
+            int frame_Index = -1;
+            uint64_t frame_Counter = 0;
+            Frame_View current_Frame;
+    };
+
+} // namespace LD_Camera
+
+#endif // LD_REPLAY_H
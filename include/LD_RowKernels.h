@@ -0,0 +1,93 @@
+#ifndef LD_ROWKERNELS_H
+#define LD_ROWKERNELS_H
+
+#include <cstdint>
+
+#include "LD_Simd.h"
+
+// Building blocks for the projection kernels in LD_SpotKernels. Each works
+// on one line of raw driver data (see LD_Camera::Frame_View for the layout)
+// and uses SSE2/AVX2 where the CPU has it.
+namespace LD_QuarcTracker{
+
+    // Both of these can take a line of background pixel values (see
+    // Background_Model) to subtract from the pixels first, saturating at 0.
+    // nullptr means no background.
+
+    // What Row_Max can add up about a line while it's at it.
+    struct Row_Sums{
+        // Of the pixel values (after the background is taken off).
+        uint64_t total;
+        uint64_t total_Squares;
+        // Pixels at the top of the range, before the background.
+        int n_Saturated;
+    };
+
+    // Brightest pixel value in the line. If sums isn't nullptr the line is
+    // added to it as well.
+    uint16_t Row_Max(const uint8_t* row, int width, int bits_Per_Pixel,
+                     const uint16_t* background = nullptr, Row_Sums* sums = nullptr);
+
+    // Count the pixels of the line into banks (histogram_Banks histograms
+    // of histogram_Bins, histogram_Bank_Stride apart, see LD_Histogram),
+    // pixel value >> bin_Shift being the bin. The pixels are unpacked (and
+    // the background taken off) with SIMD, but there's no SIMD for the
+    // counting itself so that's one at a time, spread over the banks.
+    void Row_Histogram(const uint8_t* row, int width, int bits_Per_Pixel, int bin_Shift,
+                       uint32_t* banks, const uint16_t* background = nullptr);
+
+    // Add every pixel brighter than thresh to its column of col_Acc and to
+    // row_Total, return how many there were. No branches on the pixel
+    // values, everything is done with compare and mask. 32 bit totals are
+    // plenty for a single frame (1280x1024 pixels of 10 bits can't overflow)
+    int Project_Row(const uint8_t* row, int width, int bits_Per_Pixel, uint16_t thresh,
+                    uint32_t* col_Acc, uint32_t& row_Total, const uint16_t* background = nullptr);
+
+    // Row_Max and Project_Row over a whole Width x Height block of rows
+    // (stride bytes apart), for frames whose size is known at compile time.
+    // The loops along the rows unroll completely with no tail, and the SIMD
+    // level, pixel type and background are sorted out once for the block
+    // rather than once per row. background_Stride is how far apart (in
+    // pixels) the background lines are, 0 for the same line every row.
+    // Only there for 128x128 and 256x256, the AOI sizes.
+
+    // The row maxima into row_Max and the sums of each row added to sums
+    // (Height of each, or nullptr to skip them), returns the brightest
+    // pixel.
+    template <int Width, int Height>
+    uint16_t Fixed_Rows_Max(const uint8_t* rows, int stride, int bits_Per_Pixel,
+                            const uint16_t* background, int background_Stride,
+                            uint16_t* row_Max, Row_Sums* sums);
+
+    // Project the rows whose maximum is over thresh into col_Acc, and set
+    // their row_Totals. Returns how many pixels counted.
+    template <int Width, int Height>
+    int Fixed_Project_Rows(const uint8_t* rows, int stride, int bits_Per_Pixel,
+                           const uint16_t* background, int background_Stride, uint16_t thresh,
+                           const uint16_t* row_Max, uint64_t* row_Totals, uint32_t* col_Acc);
+
+    // Sum n_Blocks factor x factor blocks of pixels sitting side by side,
+    // starting at the top left of the band (first_Row). stride is the bytes
+    // from one line to the next. SIMD for blocks of 4 or 8 (at most 10 bit
+    // pixels), plain C++ for any other size.
+    void Box_Sum_Band(const uint8_t* first_Row, int stride, int bits_Per_Pixel, int factor,
+                      int n_Blocks, uint32_t* sums);
+
+    // For Background_Model. Move each of average (fixed point, with
+    // fraction_Bits, at least 1, below the pixel value) 1 / 2^rate_Shift of
+    // the way towards the pixel, and round the result into estimate as
+    // pixel values.
+    void Average_Row(const uint8_t* row, int width, int bits_Per_Pixel, int fraction_Bits, int rate_Shift,
+                     uint32_t* average, uint16_t* estimate);
+
+    // One row of the summed-area table in Integral_Image. line is pixel
+    // values (already corrected), anything at or below floor counts as 0
+    // and the rest have floor taken off. sum_I is above_I (the row before)
+    // plus the running total of the row so far. The totals are 32 bit and
+    // allowed to wrap round, differences of them still come out right for
+    // any window that adds up to less.
+    void Integral_Row(const uint16_t* line, int width, uint16_t floor, const uint32_t* above_I, uint32_t* sum_I);
+
+} // namespace LD_QuarcTracker
+
+#endif // LD_ROWKERNELS_H
@@ -0,0 +1,48 @@
+#ifndef LD_SIMD_H
+#define LD_SIMD_H
+
+#include <string>
+
+// The pixel crunching kernels have SSE2 and AVX2 versions as well as plain
+// C++. Which one runs is decided at runtime by what the CPU supports, so
+// the same binary still works on an old machine. The compiler is asked to
+// build the fancy versions function by function (LD_TARGET_*) rather than
+// for the whole program.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define LD_SIMD_X86 1
+    #define LD_TARGET_SSE2 __attribute__((target("sse2")))
+    #define LD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define LD_SIMD_X86 0
+#endif
+
+// Inline everything the function calls, so kernels built for a fixed frame
+// size (see Fixed_Rows_Max) get the size as a constant all the way down.
+#if defined(__GNUC__) || defined(__clang__)
+    #define LD_FLATTEN __attribute__((flatten))
+#else
+    #define LD_FLATTEN
+#endif
+
+namespace LD_Simd{
+
+    enum Simd_Level{
+        SIMD_NONE = 0,
+        SIMD_SSE2 = 1,
+        SIMD_AVX2 = 2
+    };
+
+    // The best the CPU can do.
+    Simd_Level Cpu_Simd_Level();
+
+    // The level the kernels are currently using. Defaults to the best the
+    // CPU can do, can be turned down (e.g. to benchmark/compare against the
+    // plain versions) but not up past what the CPU supports.
+    Simd_Level Get_Simd_Level();
+    Simd_Level Set_Simd_Level(Simd_Level new_Level);
+
+    std::string Simd_Level_Name(Simd_Level level);
+
+} // namespace LD_Simd
+
+#endif // LD_SIMD_H
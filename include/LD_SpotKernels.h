@@ -0,0 +1,186 @@
+#ifndef LD_SPOTKERNELS_H
+#define LD_SPOTKERNELS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "LD_Background.h"
+#include "LD_Frame.h"
+#include "LD_Histogram.h"
+#include "LD_PixelMap.h"
+#include "LD_RowKernels.h"
+
+// The number crunching parts of the spot finder, kept apart from
+// TrackerCamera so they can be benchmarked/checked without a camera.
+namespace LD_QuarcTracker{
+
+    // Pixels at or below this are never counted, whatever the maximum.
+    // Unless the threshold is adaptive, see Adaptive_Thresh.
+    const uint16_t abs_Thresh = 50;
+
+    // What a projection kernel finds out about the frame, besides the
+    // row and column totals themselves.
+    struct Projection_Stats{
+        // Brightest pixel in the frame.
+        uint16_t max_Pixel;
+        // Pixels had to be brighter than this (and noise_Floor) to count.
+        uint16_t peak_Thresh;
+        // How many did.
+        int n_Peak_Pixels;
+        // Project_Predicted only. The guess at the maximum was too far out
+        // so the frame had to be projected again.
+        bool rescanned;
+        // Pixels at the top of the camera's range, before any corrections.
+        int n_Saturated;
+        // Mean and standard deviation of the corrected pixels in the rows
+        // with nothing over the threshold, ie. away from the spot. The
+        // whole frame if every row has something.
+        float background_Mean;
+        float background_Noise;
+        // abs_Thresh, or from the histogram with Adaptive_Thresh.
+        uint16_t noise_Floor;
+    };
+
+    // Thresholds from each frame's histogram of pixel values, so they follow
+    // the background and the spot as they drift rather than being fixed.
+    // The spot is a small part of the frame, so the median pixel is the
+    // background and the spread round it is the noise. The noise floor
+    // (used instead of abs_Thresh) is the median plus noise_Sigmas standard
+    // deviations, and peak_Thresh is measured up from the median to the
+    // maximum rather than from 0. The histogram is filled during the sweep
+    // for the row maxima, so it doesn't take another pass over the frame.
+    // Only some of the rows are counted on big frames, see
+    // Histogram_Row_Step.
+    struct Adaptive_Thresh{
+        bool enabled;
+        double noise_Sigmas;
+    };
+
+    // Counting the histogram costs a lot more than finding the maximum (it
+    // can't be done with SIMD, about 0.5 ns a pixel against 0.05) and the
+    // noise floor comes out the same from 16k pixels as from 64k, so on
+    // frames bigger than histogram_Sample_Pixels only every this many rows
+    // are counted. Much fewer and the rows counted are far enough apart
+    // that a gradient across the frame moves the floor.
+    const int histogram_Sample_Pixels = 16384;
+    int Histogram_Row_Step(const LD_Camera::Frame_View& my_Frame);
+
+    // Fill in stats.peak_Thresh and stats.noise_Floor for a frame whose
+    // brightest pixel is stats.max_Pixel, and return what pixels have to be
+    // brighter than, the higher of the two. histogram (finished, see
+    // Finish_Histogram) is only looked at if adaptive is enabled.
+    uint16_t Pick_Threshold(const Pixel_Histogram* histogram, double peak_Thresh,
+                            const Adaptive_Thresh& adaptive, Projection_Stats& stats);
+
+    // What to correct the pixels for before they're thresholded. Either
+    // can be nullptr.
+    struct Pixel_Corrections{
+        // Taken off every pixel, see LD_Background. Only used once Ready.
+        const Background_Model* background;
+        // Hot and stuck pixels are replaced by the average of their
+        // neighbours in the row, and the column offsets are taken off
+        // (unless there's a background, which already includes them).
+        const LD_Camera::Pixel_Map* pixel_Map;
+    };
+
+    // The corrections for one row of a frame.
+    struct Row_Corrections{
+        // Pixel values to take off each pixel (saturating), or nullptr.
+        const uint16_t* subtract;
+        LD_Camera::Bad_Columns bad;
+    };
+
+    Row_Corrections Corrections_For_Row(const Pixel_Corrections& corrections,
+                                        const LD_Camera::Frame_View& my_Frame, int row);
+
+    // Brightest corrected pixel in row. Rows without bad pixels go straight
+    // to the SIMD row kernel, rows with them are done in pieces round them.
+    // The row is added to sums too if it isn't nullptr (see Row_Max), and
+    // counted into histogram likewise, while it's in cache.
+    uint16_t Corrected_Row_Max(const LD_Camera::Frame_View& my_Frame, int row,
+                               const Row_Corrections& row_Corrections,
+                               Row_Sums* sums = nullptr, Pixel_Histogram* histogram = nullptr);
+
+    // Unpack row to pixel values with the corrections applied.
+    void Corrected_Row(const LD_Camera::Frame_View& my_Frame, int row,
+                       const Row_Corrections& row_Corrections, uint16_t* line);
+
+    // Fill in the saturation and background parts of stats from the sums
+    // of each row (see Corrected_Row_Max). The background is from the rows
+    // with nothing over thresh, or all of them if there aren't any. Leaves
+    // stats alone if row_Sums is empty.
+    void Background_Stats(const LD_Camera::Frame_View& my_Frame, const std::vector<uint16_t>& row_Max,
+                          const std::vector<Row_Sums>& row_Sums, uint16_t thresh, Projection_Stats& stats);
+
+    // Scratch space for the faster kernels, keep one around rather than
+    // allocating every frame.
+    struct Projection_Scratch{
+        // Sum every row as it's swept for n_Saturated, background_Mean and
+        // background_Noise in Projection_Stats, which are left at 0
+        // otherwise. The reference always sums them.
+        bool metrics = true;
+        std::vector<uint16_t> row_Max;
+        std::vector<Row_Sums> row_Sums;
+        std::vector<uint32_t> col_Acc;
+        Pixel_Histogram histogram;
+    };
+
+    // Project the frame onto the X and Y axes, only counting pixels brighter
+    // than peak_Thresh * the brightest pixel. row_Totals/col_Totals are
+    // resized to fit the frame. All of them can take corrections to apply
+    // to every pixel first, in which case the maximum and the thresholds
+    // are of the corrected pixels. All but Project_Predicted can take an
+    // Adaptive_Thresh as well.
+    //
+    // The straightforward version. Finds the maximum in one sweep over the
+    // frame then projects it in a second. Use it to check the others.
+    Projection_Stats Project_Reference(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                                       std::vector<uint64_t>& row_Totals,
+                                       std::vector<uint64_t>& col_Totals,
+                                       const Pixel_Corrections& corrections = Pixel_Corrections(),
+                                       const Adaptive_Thresh& adaptive = Adaptive_Thresh());
+
+    // Gives the same answer as Project_Reference but streams through the
+    // frame once, finding the maximum of every row as it goes. The
+    // projection then only has to revisit the rows whose maximum is over
+    // the threshold, ie. the handful the spot is in. Both steps use the
+    // SIMD row kernels from LD_RowKernels.
+    Projection_Stats Project_Fused(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                                   std::vector<uint64_t>& row_Totals,
+                                   std::vector<uint64_t>& col_Totals,
+                                   Projection_Scratch& scratch,
+                                   const Pixel_Corrections& corrections = Pixel_Corrections(),
+                                   const Adaptive_Thresh& adaptive = Adaptive_Thresh());
+
+    // Projects in a single pass by taking the threshold from a guess at
+    // the maximum (predicted_Max, e.g. from the previous frame) rather than
+    // finding it first. The real maximum is found along the way. If it
+    // turns out to be more than rescan_Fraction away from the guess the
+    // bright rows are projected again with the right threshold (and
+    // stats.rescanned is set), otherwise the answer stands. So it only
+    // matches Project_Reference exactly when it rescans, or the guess was
+    // spot on. No Adaptive_Thresh, that needs the whole frame seen first.
+    Projection_Stats Project_Predicted(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                                       uint16_t predicted_Max, double rescan_Fraction,
+                                       std::vector<uint64_t>& row_Totals,
+                                       std::vector<uint64_t>& col_Totals,
+                                       Projection_Scratch& scratch,
+                                       const Pixel_Corrections& corrections = Pixel_Corrections());
+
+    // Project_Fused for frames the size of the AOI (128x128 and 256x256),
+    // using the Fixed_ row kernels compiled for that size. Anything else
+    // (another size, bad pixels to replace, adaptive thresholds) goes to
+    // Project_Fused. Same answer either way.
+    Projection_Stats Project_Fixed(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                                   std::vector<uint64_t>& row_Totals,
+                                   std::vector<uint64_t>& col_Totals,
+                                   Projection_Scratch& scratch,
+                                   const Pixel_Corrections& corrections = Pixel_Corrections(),
+                                   const Adaptive_Thresh& adaptive = Adaptive_Thresh());
+
+    // Is my_Frame a size Project_Fixed has kernels for?
+    bool Fixed_Geometry(const LD_Camera::Frame_View& my_Frame);
+
+} // namespace LD_QuarcTracker
+
+#endif // LD_SPOTKERNELS_H
@@ -0,0 +1,54 @@
+#ifndef LD_SYNTHETIC_H
+#define LD_SYNTHETIC_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Made up frames of a gaussian spot with the sort of noise and faults the
+// real sensor has, and the true spot position to check the spot finder
+// against. Feed them to LD_Camera::Frame_Replay.
+namespace LD_Camera{
+
+    struct Synthetic_Options{
+        int width;
+        int height;
+        int bits_Per_Pixel;
+        // Centre of the spot in pixels (0, 0 being the middle of the top
+        // left pixel) and its standard deviation.
+        double spot_X;
+        double spot_Y;
+        double sigma;
+        // Electrons at the very top of the spot, and in every pixel at the
+        // top left of the frame.
+        double peak_Electrons;
+        double background_Electrons;
+        // How much the background goes up per pixel right and down, in
+        // electrons.
+        double gradient_X;
+        double gradient_Y;
+        // Electrons per count, and the read noise in electrons rms.
+        double gain;
+        double read_Noise;
+        // Poisson noise on the electrons.
+        bool shot_Noise;
+        // Fraction of the pixels that are hot, and the most counts one can
+        // have on top of what it should be.
+        double hot_Fraction;
+        int hot_Max;
+    };
+
+    // A spot most of the way to the top of the range in the middle of the
+    // frame, on a slight gradient, with both sorts of noise and a few hot
+    // pixels. Change what's needed from there.
+    Synthetic_Options Default_Synthetic(int width, int height, int bits_Per_Pixel);
+
+    // Pixel values (as Frame_Replay::Add_Frame takes them). The spot is
+    // integrated over each pixel rather than sampled at its middle, so its
+    // centroid is exactly spot_X, spot_Y before the noise goes on. The hot
+    // pixels are wherever random_Engine puts them.
+    std::vector<uint16_t> Make_Synthetic_Frame(const Synthetic_Options& options, std::mt19937& random_Engine);
+
+} // namespace LD_Camera
+
+#endif // LD_SYNTHETIC_H
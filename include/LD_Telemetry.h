@@ -0,0 +1,117 @@
+#ifndef LD_TELEMETRY_H
+#define LD_TELEMETRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "LD_Frame.h"
+
+// Publishes what the tracker is doing every step into POSIX shared memory
+// (/dev/shm/<name> on Linux) for other programs to watch, e.g.
+// telemetry_reader.py. Readers map it read-only so they can't upset the
+// tracker, and the tracker never waits for them.
+//
+// Layout (all little endian, offsets in bytes):
+//  Telemetry_Header at 0, then n_Slots slots of slot_Bytes each starting
+//  at header_Bytes. Step n goes in slot n % n_Slots. Each slot is a
+//  Telemetry_Record followed by the frame's pixels (if a reader is
+//  subscribed), rows packed with no padding, exactly as the camera gave
+//  them (so MONO16 values are in the top bits_Per_Pixel bits).
+//
+// Each record is a seqlock. sequence is odd while the tracker is writing
+// the slot. A reader copies the slot and keeps the copy if sequence was
+// the same even number before and after. The ring means a reader that's
+// slow copying one slot doesn't get overwritten until n_Slots steps later.
+//
+// Copying the pixels is most of the cost, so it's only done if a reader
+// has written the time (CLOCK_MONOTONIC, in ns) to the first 8 bytes of
+// <name>_readers within the last second. That segment is the only one
+// readers write to.
+
+const uint32_t telemetry_Magic = 0x54514C44; // "LDQT"
+const uint32_t telemetry_Version = 1;
+
+struct Telemetry_Header{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t n_Slots;
+    uint32_t slot_Bytes;
+    // Where slot 0 starts, and where the pixels start in each slot.
+    uint32_t header_Bytes;
+    uint32_t record_Bytes;
+    uint32_t max_Pixel_Bytes;
+    uint32_t reserved;
+    // Steps published so far. The newest is in slot
+    // (write_Count - 1) % n_Slots.
+    std::atomic<uint64_t> write_Count;
+};
+
+// The tracker's state after one step.
+struct Telemetry_Values{
+    uint64_t step_Number;
+    uint64_t frame_ID;
+    // steady_clock (CLOCK_MONOTONIC) when it was published, in ns.
+    uint64_t time_Ns;
+    // The frame, as in LD_Camera::Frame_View. pixel_Bytes is 0 if nobody
+    // was subscribed so the pixels weren't copied.
+    int32_t width;
+    int32_t height;
+    int32_t offset_X;
+    int32_t offset_Y;
+    int32_t bits_Per_Pixel;
+    uint32_t pixel_Bytes;
+    // Bit 0: spot found, bit 1: tracker on, bit 2: AOI set.
+    uint32_t flags;
+    // Spot relative to the frame, its distance from the set point, and the
+    // mirror position.
+    float spot_X;
+    float spot_Y;
+    float error_X;
+    float error_Y;
+    float mirror_X;
+    float mirror_Y;
+};
+
+const uint32_t telemetry_Spot_Found = 1;
+const uint32_t telemetry_Tracker_On = 2;
+const uint32_t telemetry_AOI_Set = 4;
+
+struct Telemetry_Record{
+    std::atomic<uint64_t> sequence;
+    Telemetry_Values values;
+};
+
+class LD_Telemetry
+{
+    public:
+        LD_Telemetry();
+        // Unlinks the segments if they're open.
+        ~LD_Telemetry();
+
+        // Make the segments. name starts with a '/', e.g.
+        // "/ld_quarctracker". max_Pixel_Bytes is the biggest frame that
+        // will ever be published. Returns 1 if they couldn't be made,
+        // which is always anywhere but Linux.
+        int Open(const std::string& name, int n_Slots, uint32_t max_Pixel_Bytes);
+        int Close();
+        bool Is_Open();
+
+        // Whether a reader has checked in recently.
+        bool Reader_Subscribed();
+
+        // Put values (and my_Frame's pixels, if anyone's watching) in the
+        // next slot. The frame fields in values are filled in here. Copying
+        // the pixels counts as an image copy (see Count_Image_Copy).
+        int Publish(Telemetry_Values values, const LD_Camera::Frame_View& my_Frame);
+
+    private:
+        std::string segment_Name;
+        uint8_t* segment = nullptr;
+        size_t segment_Bytes = 0;
+        // Readers' heartbeat.
+        std::atomic<uint64_t>* readers = nullptr;
+        Telemetry_Header* header = nullptr;
+};
+
+#endif // LD_TELEMETRY_H
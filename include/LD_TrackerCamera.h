@@ -1,7 +1,17 @@
 #ifndef TRACKERCAMERA_H
 #define TRACKERCAMERA_H
 
+#include "LD_Background.h"
+#include "LD_Blobs.h"
 #include "LD_Camera.h"
+#include "LD_Estimators.h"
+#include "LD_GaussFit.h"
+#include "LD_Pyramid.h"
+#include "LD_Sparse.h"
+#include "LD_SpotKernels.h"
+
+#include <map>
+#include <string>
 
 #define HAVE_OPENCV
 #ifdef HAVE_OPENCV
@@ -14,11 +24,163 @@
 
 namespace LD_QuarcTracker{
 
+    // How the spot finder gets from the pixels to a position.
+    enum Spot_Estimator{
+        // Thresholded centroid of the X and Y projections.
+        ESTIMATOR_CENTROID,
+        // Least squares fit of a 2D gaussian to a window of pixels round
+        // the centroid.
+        ESTIMATOR_GAUSS_FIT,
+        // Parabola through the peak of each projection and its neighbours
+        // (see Parabolic_Peak).
+        ESTIMATOR_PARABOLIC,
+        // The same through their logs (see Gaussian_Peak).
+        ESTIMATOR_GAUSS_3POINT,
+        // Centroid of window_Half_Width bins either side of the peak of
+        // each projection (see Windowed_Centroid).
+        ESTIMATOR_WINDOWED
+    };
+
+    // From the name used in the ini file ("centroid", "gauss_fit",
+    // "parabolic", "gauss_3point", "windowed"). Unknown names give the
+    // centroid.
+    Spot_Estimator Estimator_From_Name(std::string name);
+
+    // Why the spot finder didn't find the spot.
+    enum Spot_Failure{
+        SPOT_OK,
+        // No frame to look at.
+        SPOT_NO_FRAME,
+        // Too few pixels over the threshold, the spot is too faint (or
+        // not there).
+        SPOT_TOO_FAINT,
+        // Too many, the spot is too big or blurred, or the whole frame is
+        // too bright.
+        SPOT_TOO_BIG,
+        // blob_Detection only. There were blobs but none looked like the
+        // spot.
+        SPOT_NO_BLOB
+    };
+
+    // For printing ("ok", "no_frame", "too_faint", "too_big", "no_blob").
+    std::string Spot_Failure_Name(Spot_Failure failure);
+
+    // How the spot looked on a frame, all worked out from the sums the
+    // spot finder collects as it reads the frame so it costs no extra
+    // passes over the pixels. If the spot was found it's from the part of
+    // the frame it was found in (e.g. the ROI), otherwise from the last
+    // place it looked.
+    struct Spot_Result{
+        bool found;
+        Spot_Failure failure;
+        // Brightest (corrected) pixel, and how many pixels were at the top
+        // of the camera's range. Any saturated pixels and the exposure is
+        // too long. n_Saturated, background, noise and snr are 0 unless
+        // spot_Metrics (or fused_Kernel is off).
+        uint16_t peak;
+        int n_Saturated;
+        // Mean and standard deviation of the pixels away from the spot, and
+        // the peak above the background in standard deviations.
+        float background;
+        float noise;
+        float snr;
+        // Pixels counted towards the spot position, and what they had to
+        // be brighter than. The noise floor is fixed unless adaptive_Thresh.
+        int n_Peak_Pixels;
+        uint16_t threshold;
+        uint16_t noise_Floor;
+        // Brightness weighted standard deviations of the counted pixels in
+        // X and Y, and 1 - minor/major axis. Only found spots have these.
+        // The projections can't see a tilted ellipse, so unless
+        // blob_Detection is on the axes are X and Y.
+        float width_X;
+        float width_Y;
+        float ellipticity;
+        // Bytes of the frame read to get here. Every pass over a window
+        // counts all of its pixels, the sparse search the cache lines its
+        // samples are in.
+        uint64_t bytes_Read;
+    };
+
     struct SpotFinderOptions{
         double peak_Thresh;
         double gaussian_Thresh;
         int n_Peak_Pixels;
         bool save_Data;
+        // Use the single sweep projection kernel rather than the reference
+        // one, and optionally check every frame against the reference.
+        bool fused_Kernel;
+        bool validate_Kernel;
+        // Threshold each frame from the previous frame's maximum so it only
+        // has to be read once. If the maximum has moved by more than
+        // rescan_Fraction the frame is projected again properly.
+        bool predict_Thresh;
+        double rescan_Fraction;
+        // Look for the spot in a roi_Size square around where it was last
+        // time (moved on and widened by how fast it was moving) before
+        // trying the whole frame. Only used on frames bigger than the window.
+        bool roi_Search;
+        int roi_Size;
+        // Failing that, shrink the frame by pyramid_Factor (summing blocks
+        // of pixels) and look in a pyramid_Window square around the
+        // brightest block before trying the whole frame.
+        bool pyramid_Search;
+        int pyramid_Factor;
+        int pyramid_Window;
+        // For ESTIMATOR_GAUSS_FIT, the side of the square of pixels fitted
+        // and the most iterations allowed per frame.
+        Spot_Estimator estimator;
+        int fit_Window;
+        int fit_Max_Iterations;
+        // Rather than projecting the whole frame, find every blob of bright
+        // pixels and pick the spot from them with blob_Ranking, so another
+        // bright thing in the frame doesn't lose the spot. n_Peak_Pixels is
+        // then the biggest a blob can be and still be the spot.
+        bool blob_Detection;
+        Blob_Ranking blob_Ranking;
+        int blob_Expected_Area;
+        // Keep a running average of every pixel (one per frame geometry,
+        // so the full frame and each AOI have their own) and take it off
+        // before thresholding. It's updated every background_Update_Period
+        // frames, over roughly the last background_Frames updates (rounded
+        // to a power of 2), leaving out a background_Skip square round the
+        // spot. Saved in background_Path (if not empty) when the camera goes
+        // away and loaded again next time.
+        bool background_Subtract;
+        int background_Frames;
+        int background_Update_Period;
+        int background_Skip;
+        std::string background_Path;
+        // Take the camera's pixel map (hot and stuck pixels, column offsets,
+        // see LD_Camera::Pixel_Map) out of the frame before thresholding.
+        // Does nothing if the camera hasn't got one.
+        bool pixel_Map_Correct;
+        // Pick the thresholds from each frame's histogram (see
+        // Adaptive_Thresh), with the noise floor noise_Sigmas standard
+        // deviations above the background. Not with predict_Thresh, which
+        // is ignored.
+        bool adaptive_Thresh;
+        double noise_Sigmas;
+        // Use the projection kernels compiled for 128x128 and 256x256
+        // frames (see Project_Fixed) when the frame is one of those sizes
+        // and fused_Kernel is on. Other sizes use the fused kernel as usual.
+        bool fixed_Kernels;
+        // For ESTIMATOR_WINDOWED, how many bins either side of the peak go
+        // in the centroid.
+        int window_Half_Width;
+        // Or read every k'th pixel of every k'th row (k from Sparse_Stride
+        // of sparse_Spot_Size, the smallest the spot gets across, in
+        // pixels), and look where the bright samples are. Goes before
+        // pyramid_Search. Off if that stride is under sparse_Min_Stride,
+        // and only used on frames with at least sparse_Min_Pixels pixels:
+        // the AOI sizes are quicker with the fixed kernels.
+        bool sparse_Search;
+        int sparse_Spot_Size;
+        int sparse_Min_Pixels;
+        // Sum every row as the frame's swept for n_Saturated, background,
+        // noise and snr in Spot_Result (see Projection_Scratch). They're
+        // only logged, so it's off unless they're wanted.
+        bool spot_Metrics;
     };
 
     class TrackerCamera : public LD_Camera::Camera{
@@ -26,47 +188,135 @@ namespace LD_QuarcTracker{
         // Adds a spot finder which assumes a single gaussian(ish) spot
         // somewhere in the frame.
         public:
+            // Saves the backgrounds, if there are any.
+            ~TrackerCamera();
             int Set_SpotFinder_Options(SpotFinderOptions options);
-            // The actual spot finder.
-            bool Spot_Finder(LD_Camera::Subpixel_Values& spot_Coords);
-            #ifdef HAVE_OPENCV
-            // Displays camera feed with various overlays depending on the
-            // setting in display_Mode.
-            int Show_Image(int display_Mode);
-            #endif // HAVE_OPENCV
+            // The actual spot finder. Looks at the most recent frame from
+            // Take_Picture. spot_Coords is only meaningful if the result
+            // says the spot was found.
+            Spot_Result Spot_Finder(LD_Camera::Subpixel_Values& spot_Coords);
+            // Or run it on any frame (e.g. from LD_Camera::Frame_Replay).
+            // Co-ordinates are relative to the top left of my_Frame.
+            Spot_Result Spot_Finder(const LD_Camera::Frame_View& my_Frame,
+                                    LD_Camera::Subpixel_Values& spot_Coords);
+            // Number of frames the spot finder had to project twice because
+            // the predicted maximum was wrong (see predict_Thresh), since
+            // the camera was made.
+            uint64_t Get_Threshold_Rescans();
+            // How the gaussian fit went on the last frame (iterations is 0
+            // if it wasn't run).
+            Gauss_Fit_Result Get_Last_Fit();
+            // Number of blobs in the last frame (0 if not blob_Detection)
+            int Get_Blob_Count();
+            // Write every background model to background_Path (one file
+            // per frame geometry).
+            int Save_Backgrounds();
 
         private:
-            // Project the image as histograms on the X and Y axis.
-            int Project_Image_XY();
+            // Decide whether there's a spot in my_Frame and where it is.
+            // Co-ordinates are relative to the top left of my_Frame.
+            bool Find_Spot(const LD_Camera::Frame_View& my_Frame,
+                           LD_Camera::Subpixel_Values& spot_Coords, bool report_Errors);
+            // Find_Spot on a window inside my_Frame, false if it's not in
+            // there (or only partly). Co-ordinates relative to my_Frame.
+            bool Search_Window(const LD_Camera::Frame_View& my_Frame,
+                               const LD_Camera::Frame_View& window,
+                               LD_Camera::Subpixel_Values& spot_Coords);
+            // Find_Spot for blob_Detection.
+            bool Find_Blob_Spot(const LD_Camera::Frame_View& my_Frame,
+                                LD_Camera::Subpixel_Values& spot_Coords, bool report_Errors);
+            // The part of my_Frame around the brightest block of pixels.
+            LD_Camera::Frame_View Pyramid_Window(const LD_Camera::Frame_View& my_Frame);
+            // The part of my_Frame round the samples bright enough to be the
+            // spot.
+            LD_Camera::Frame_View Sparse_Window(const LD_Camera::Frame_View& my_Frame);
+            // The part of my_Frame the spot is expected to be in this time.
+            LD_Camera::Frame_View ROI_Window(const LD_Camera::Frame_View& my_Frame);
+            // After projecting roi_Frame, does the spot run off the edge of
+            // it? If so the whole frame has to be searched after all.
+            bool ROI_Clipped(const LD_Camera::Frame_View& my_Frame,
+                             const LD_Camera::Frame_View& roi_Frame);
+            // Remember where (on the sensor) the spot was, and how fast it's
+            // moving, for the next ROI_Window.
+            int Update_ROI(const LD_Camera::Frame_View& my_Frame,
+                           LD_Camera::Subpixel_Values spot_Coords);
+            // The background model for frames like my_Frame, made (and
+            // loaded from background_Path, if it was saved) the first time.
+            Background_Model& Background_For(const LD_Camera::Frame_View& my_Frame);
+            // Fold my_Frame into its background, if it's time to, leaving out
+            // the pixels round the spot.
+            int Update_Background(const LD_Camera::Frame_View& my_Frame);
+            std::string Background_File(const LD_Camera::Frame_View& my_Frame);
+            // Project the image as histograms on the X and Y axis. Reads the
+            // frame where it is, without copying it anywhere first.
+            int Project_Image_XY(const LD_Camera::Frame_View& my_Frame);
             // Save X&Y projections of camera image from spot finder.
             int Save_Projections();
             // Get weighted average X value of a distribution
             float Weighted_Average(std::vector<uint64_t> &distribution);
+            // Centre of a projection to subpixel accuracy, by whichever
+            // estimator is picked (the centroid for the gaussian fit).
+            float Projection_Peak(std::vector<uint64_t> &distribution);
+            // Standard deviation of a distribution about its mean.
+            float Weighted_Spread(const std::vector<uint64_t>& distribution, float mean);
+            // Fill in spot_Result from frame_Stats.
+            int Fill_Spot_Result(bool spot_Found);
+            // Refine spot_Coords (from the centroid, relative to my_Frame) by
+            // fitting a gaussian round them. Leaves them alone if the fit
+            // fails.
+            int Gauss_Fit_Spot(const LD_Camera::Frame_View& my_Frame,
+                               LD_Camera::Subpixel_Values& spot_Coords);
 
-            #ifdef HAVE_OPENCV
-            // Make an opencv mat from the image buffer vector so opencv can
-            // understand it. Probaly a bit inefficient but the display should
-            // be disabled in production when performance actually matters.
-            int Make_Opencv_Mat(LD_Camera::AOI my_AOI);
-            // Open a window and display the current myMat. (which may or may
-            // not have been drawn on)
-            int Display_Mat();
-            // Draw features on myMat, if enabled, used to draw spots at the
-            // set point and tracked spot position, and a rectangle around the
-            // AOI.
-            int Draw_Spot(LD_Camera::Subpixel_Values spot_Position, cv::Scalar colour);
-            int Draw_AOI(LD_Camera::AOI my_AOI);
-
-            cv::Mat myMat;
-            #endif // HAVE_OPENCV
-
-            // The image data as a 1D vector (thus you will need to know the
-            // dimensions of the image to make sense of this.
-            std::vector<uint16_t> image_Buffer;
             // For the spot finder, container for the projection of the spot
             // in X and Y.
             std::vector<uint64_t> row_Totals;
             std::vector<uint64_t> col_Totals;
+            // Scratch space for the fused projection kernel.
+            Projection_Scratch projection_Scratch;
+            // Shrunk frame for the pyramid search.
+            Pyramid_Image pyramid_Image;
+            // Samples for the sparse search.
+            Sparse_Grid sparse_Grid;
+            // For the gaussian fit.
+            Gauss_Fit_Scratch fit_Scratch;
+            Gauss_Fit_Result last_Fit = Gauss_Fit_Result();
+            // For the blob detection, the blob picked as the spot last.
+            std::vector<Blob> blobs;
+            Blob_Scratch blob_Scratch;
+            Blob chosen_Blob = Blob();
+            int last_Blob_Count = 0;
+            // Background models by Background_Model::Geometry_Name, the file
+            // each one is saved to, and the corrections (background and
+            // pixel map) for the frame being searched.
+            std::map<std::string, Background_Model> backgrounds;
+            std::map<std::string, std::string> background_Files;
+            Pixel_Corrections frame_Corrections;
+            int frames_Since_Background = 0;
+            // Has the spot ever been found? If not there's nothing to keep
+            // out of the background.
+            bool spot_Seen = false;
+
+            // What the last projection (or blob search) found out about
+            // the frame, and what's made of it for Spot_Finder to return.
+            Projection_Stats frame_Stats = {0, 0, 0, false, 0, 0, 0, 0};
+            Spot_Result spot_Result = Spot_Result();
+            // Frame memory read so far this frame, see Spot_Result.
+            uint64_t frame_Bytes_Read = 0;
+            // From my_Options.
+            Adaptive_Thresh adaptive = Adaptive_Thresh();
+
+            // Maximum pixel of the last frame projected, the guess for the
+            // next one.
+            uint16_t last_Max_Pixel = 0;
+            uint64_t threshold_Rescans = 0;
+
+            // For the ROI search. Last spot position in sensor co-ordinates
+            // (so it still means something if the AOI comes and goes) and
+            // its velocity in pixels per frame.
+            bool roi_Valid = false;
+            LD_Camera::Subpixel_Values roi_Last_Spot = {0, 0};
+            LD_Camera::Subpixel_Values roi_Velocity = {0, 0};
+            uint64_t roi_Last_Frame_ID = 0;
 
             SpotFinderOptions my_Options;
             LD_Camera::Subpixel_Values my_Spot_Coords;
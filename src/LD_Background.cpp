@@ -0,0 +1,183 @@
+#include "LD_Background.h"
+#include "LD_RowKernels.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace LD_QuarcTracker{
+    namespace{
+        // The average keeps this many bits below the pixel value, so a slow
+        // average (big rate_Shift) still moves a little every update.
+        const int fraction_Bits = 8;
+
+        // Start of every background file, and its layout version.
+        const char file_Magic[4] = {'L', 'D', 'B', 'G'};
+        const int32_t file_Version = 1;
+
+        struct File_Header{
+            char magic[4];
+            int32_t version;
+            int32_t width;
+            int32_t height;
+            int32_t offset_X;
+            int32_t offset_Y;
+            int32_t bits_Per_Pixel;
+            int32_t fraction_Bits;
+            uint64_t n_Updates;
+        };
+    } // namespace
+
+    Background_Model::Background_Model()
+    {
+        //ctor
+    }
+
+    Background_Model::~Background_Model()
+    {
+        //dtor
+    }
+
+    int Background_Model::Reset(const LD_Camera::Frame_View& my_Frame){
+        width = my_Frame.width;
+        height = my_Frame.height;
+        offset_X = my_Frame.offset_X;
+        offset_Y = my_Frame.offset_Y;
+        bits_Per_Pixel = my_Frame.bits_Per_Pixel;
+        n_Updates = 0;
+        average.assign(width * height, 0);
+        estimate.assign(width * height, 0);
+        return 0;
+    }
+
+    bool Background_Model::Same_Geometry(const LD_Camera::Frame_View& my_Frame) const{
+        return (my_Frame.width == width) && (my_Frame.height == height) &&
+               (my_Frame.offset_X == offset_X) && (my_Frame.offset_Y == offset_Y) &&
+               (my_Frame.bits_Per_Pixel == bits_Per_Pixel);
+    }
+
+    bool Background_Model::Ready() const{
+        return n_Updates > 0;
+    }
+
+    uint64_t Background_Model::Num_Updates() const{
+        return n_Updates;
+    }
+
+    int Background_Model::Update(const LD_Camera::Frame_View& my_Frame, int rate_Shift,
+                                 int skip_X, int skip_Y, int skip_Width, int skip_Height){
+        if (!my_Frame.Valid() || !Same_Geometry(my_Frame)){
+            std::cout << "Background is for " << width << "x" << height << " frames, can't update it from "
+                      << my_Frame.width << "x" << my_Frame.height << "\n";
+            return 1;
+        }
+        // The very first frame is taken as it is, rather than averaged in
+        // with nothing.
+        if (n_Updates == 0){
+            rate_Shift = 0;
+        }
+        rate_Shift = std::min(std::max(rate_Shift, 0), 16);
+
+        int skip_Left = std::min(std::max(skip_X, 0), width);
+        int skip_Right = std::min(std::max(skip_X + skip_Width, skip_Left), width);
+        int bytes_Per_Pixel = my_Frame.Bytes_Per_Pixel();
+        for(int row=0; row < height; row++){
+            const uint8_t* pixels = my_Frame.Row(row);
+            uint32_t* row_Average = average.data() + (row * width);
+            uint16_t* row_Estimate = estimate.data() + (row * width);
+            if ((row >= skip_Y) && (row < skip_Y + skip_Height)){
+                // Either side of the spot.
+                Average_Row(pixels, skip_Left, bits_Per_Pixel, fraction_Bits, rate_Shift,
+                            row_Average, row_Estimate);
+                Average_Row(pixels + (skip_Right * bytes_Per_Pixel), width - skip_Right, bits_Per_Pixel,
+                            fraction_Bits, rate_Shift, row_Average + skip_Right, row_Estimate + skip_Right);
+            }
+            else{
+                Average_Row(pixels, width, bits_Per_Pixel, fraction_Bits, rate_Shift, row_Average, row_Estimate);
+            }
+        }
+        n_Updates++;
+        return 0;
+    }
+
+    const uint16_t* Background_Model::Row(const LD_Camera::Frame_View& my_Frame, int row) const{
+        if (!Ready() || (my_Frame.bits_Per_Pixel != bits_Per_Pixel)){
+            return nullptr;
+        }
+        int left = my_Frame.offset_X - offset_X;
+        int top = my_Frame.offset_Y - offset_Y + row;
+        if ((left < 0) || (left + my_Frame.width > width) || (top < 0) || (top >= height)){
+            return nullptr;
+        }
+        return estimate.data() + (top * width) + left;
+    }
+
+    int Background_Model::Save(std::string file_Name) const{
+        std::ofstream file_Out(file_Name, std::ofstream::binary);
+        if (!file_Out.is_open()){
+            std::cout << "Couldn't save background to " << file_Name << "\n";
+            return 1;
+        }
+        File_Header header;
+        std::copy(file_Magic, file_Magic + 4, header.magic);
+        header.version = file_Version;
+        header.width = width;
+        header.height = height;
+        header.offset_X = offset_X;
+        header.offset_Y = offset_Y;
+        header.bits_Per_Pixel = bits_Per_Pixel;
+        header.fraction_Bits = fraction_Bits;
+        header.n_Updates = n_Updates;
+        file_Out.write((const char*)&header, sizeof(header));
+        file_Out.write((const char*)average.data(), average.size() * sizeof(uint32_t));
+        if (!file_Out.good()){
+            std::cout << "Error writing background to " << file_Name << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    int Background_Model::Load(std::string file_Name){
+        std::ifstream file_In(file_Name, std::ifstream::binary);
+        if (!file_In.is_open()){
+            // Not an error, there just isn't one yet.
+            return 1;
+        }
+        File_Header header;
+        file_In.read((char*)&header, sizeof(header));
+        if (!file_In.good() || !std::equal(file_Magic, file_Magic + 4, header.magic) ||
+            (header.version != file_Version) || (header.fraction_Bits != fraction_Bits)){
+            std::cout << file_Name << " isn't a background file this version understands" << "\n";
+            return 1;
+        }
+        if ((header.width != width) || (header.height != height) ||
+            (header.offset_X != offset_X) || (header.offset_Y != offset_Y) ||
+            (header.bits_Per_Pixel != bits_Per_Pixel)){
+            std::cout << file_Name << " is for a different frame geometry" << "\n";
+            return 1;
+        }
+
+        std::vector<uint32_t> file_Average(width * height);
+        file_In.read((char*)file_Average.data(), file_Average.size() * sizeof(uint32_t));
+        if (!file_In.good()){
+            std::cout << file_Name << " is too short" << "\n";
+            return 1;
+        }
+        average.swap(file_Average);
+        for(unsigned int i=0; i < average.size(); i++){
+            estimate[i] = (average[i] + (1 << (fraction_Bits - 1))) >> fraction_Bits;
+        }
+        n_Updates = header.n_Updates;
+        std::cout << "Loaded background from " << file_Name << " (" << n_Updates << " frames)" << "\n";
+        return 0;
+    }
+
+    std::string Background_Model::Geometry_Name(const LD_Camera::Frame_View& my_Frame){
+        std::ostringstream name;
+        name << my_Frame.width << "x" << my_Frame.height << "+" << my_Frame.offset_X << "+"
+             << my_Frame.offset_Y << "_" << my_Frame.bits_Per_Pixel << "bit";
+        return name.str();
+    }
+
+} // namespace LD_QuarcTracker
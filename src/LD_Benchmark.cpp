@@ -0,0 +1,592 @@
+#include "LD_Benchmark.h"
+#include "LD_Background.h"
+#include "LD_Blobs.h"
+#include "LD_Estimators.h"
+#include "LD_GaussFit.h"
+#include "LD_Integral.h"
+#include "LD_PixelKernels.h"
+#include "LD_PixelMap.h"
+#include "LD_Pyramid.h"
+#include "LD_Replay.h"
+#include "LD_Simd.h"
+#include "LD_Sparse.h"
+#include "LD_SpotKernels.h"
+#include "LD_Synthetic.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace{
+    struct Frame_Size{
+        int width;
+        int height;
+    };
+
+    // The sizes that actually get used, full frame and the two AOI sizes
+    // with fixed kernels.
+    const Frame_Size bench_Sizes[] = {{1280, 1024}, {256, 256}, {128, 128}};
+
+    // Project_Image_XY as it originally was, division per pixel and all.
+    LD_QuarcTracker::Projection_Stats Project_Original(const std::vector<uint16_t> &image_Buffer, int numCols,
+                                                       double peak_Thresh_Fraction,
+                                                       std::vector<uint64_t> &row_Totals,
+                                                       std::vector<uint64_t> &col_Totals){
+        row_Totals.assign(image_Buffer.size() / numCols, 0);
+        col_Totals.assign(numCols, 0);
+
+        uint16_t max_Pixel = *std::max_element(image_Buffer.begin(), image_Buffer.end());
+        uint16_t peak_Thresh = max_Pixel * peak_Thresh_Fraction;
+        uint16_t abs_Thresh = 50;
+
+        int row;
+        int col;
+        int x = 0;
+        int n_Peak_Pixels = 0;
+        for(auto pixel : image_Buffer){
+            if((pixel > peak_Thresh) & (pixel > abs_Thresh)){
+                row = std::floor(x / numCols);
+                col = x % numCols;
+
+                row_Totals[row] += pixel;
+                col_Totals[col] += pixel;
+                n_Peak_Pixels++;
+            }
+            x++;
+        }
+        return {max_Pixel, peak_Thresh, n_Peak_Pixels, false, 0, 0, 0, abs_Thresh};
+    }
+
+    // Every frame's projections from one stage, to check against another's.
+    struct Projection_Set{
+        std::vector<LD_QuarcTracker::Projection_Stats> stats;
+        std::vector<std::vector<uint64_t>> rows;
+        std::vector<std::vector<uint64_t>> cols;
+
+        Projection_Set(int n_Frames) : stats(n_Frames), rows(n_Frames), cols(n_Frames){}
+    };
+
+    // The same totals from the same pixels, and the same background.
+    bool Same_Projections(const Projection_Set& a, const Projection_Set& b){
+        for(unsigned int i=0; i < a.stats.size(); i++){
+            if((a.rows[i] != b.rows[i]) || (a.cols[i] != b.cols[i]) ||
+               (a.stats[i].max_Pixel != b.stats[i].max_Pixel) ||
+               (a.stats[i].n_Peak_Pixels != b.stats[i].n_Peak_Pixels) ||
+               (a.stats[i].noise_Floor != b.stats[i].noise_Floor) ||
+               (a.stats[i].background_Mean != b.stats[i].background_Mean) ||
+               (a.stats[i].background_Noise != b.stats[i].background_Noise)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // stage at a SIMD level. The best level the CPU has (what the tracker
+    // uses) keeps the plain name, so runs on different machines line up.
+    std::string Level_Stage(std::string stage, LD_Simd::Simd_Level level){
+        if(level == LD_Simd::Cpu_Simd_Level()){
+            return stage;
+        }
+        return stage + "_" + LD_Simd::Simd_Level_Name(level);
+    }
+
+    // Run my_Function repeatedly for roughly min_Seconds and return the
+    // average time per call in nanoseconds.
+    template <typename Function_T>
+    double Time_Per_Call(Function_T my_Function, double min_Seconds = 0.2){
+        // Warm up (caches, page faults, CPU clocks)
+        my_Function();
+
+        int iterations = 1;
+        while(true){
+            auto start = std::chrono::steady_clock::now();
+            for(int i=0; i < iterations; i++){
+                my_Function();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= min_Seconds){
+                return 1e9 * elapsed.count() / iterations;
+            }
+            iterations *= 2;
+        }
+    }
+} // namespace
+
+int Benchmark_Suite(std::vector<Stage_Result>& results){
+    const int n_Frames = 8;
+    // Frames without the spot, to learn the background and calibrate the
+    // pixel map from.
+    const int n_Dark = 16;
+    std::cout << "Spot finder stage benchmark (synthetic frames, " << n_Frames << " spots each)" << "\n";
+    std::cout << "Best SIMD level on this CPU: "
+              << LD_Simd::Simd_Level_Name(LD_Simd::Cpu_Simd_Level()) << "\n";
+
+    std::mt19937 random_Engine(4321);
+    int n_Errors = 0;
+    LD_QuarcTracker::Pixel_Corrections no_Corrections = {nullptr, nullptr};
+    LD_Simd::Simd_Level best_Level = LD_Simd::Cpu_Simd_Level();
+
+    for (auto bench_Size : bench_Sizes){
+        // The ini file's defaults for each.
+        bool full_Frame = (bench_Size.width * bench_Size.height > 256 * 256);
+        double peak_Thresh = full_Frame ? 0.5 : 0.1;
+        double gaussian_Thresh = full_Frame ? 0.5 : 0.05;
+        for (int bits_Per_Pixel : {8, 10}){
+            int max_Value = (1 << bits_Per_Pixel) - 1;
+            LD_Camera::Frame_Replay dark_Replay;
+            for (int i=0; i < n_Dark; i++){
+                LD_Camera::Synthetic_Options options =
+                    LD_Camera::Default_Synthetic(bench_Size.width, bench_Size.height, bits_Per_Pixel);
+                options.peak_Electrons = 0;
+                dark_Replay.Add_Frame(LD_Camera::Make_Synthetic_Frame(options, random_Engine),
+                                      bench_Size.width, bench_Size.height, bits_Per_Pixel);
+            }
+            std::vector<LD_Camera::Frame_View> dark_Frames;
+            for (int i=0; i < n_Dark; i++){
+                dark_Frames.push_back(dark_Replay.Next_Frame());
+            }
+            // Calibrated as Camera::Calibrate_Pixel_Map would.
+            LD_Camera::Pixel_Map pixel_Map;
+            pixel_Map.Start_Calibration(dark_Frames[0]);
+            for (auto& dark_Frame : dark_Frames){
+                pixel_Map.Add_Calibration_Frame(dark_Frame);
+            }
+            pixel_Map.Finish_Calibration(0.5 * max_Value, 0.1);
+
+            for (double sigma : {1.5, 4.0}){
+                // Spots anywhere in the middle half of the frame.
+                std::uniform_real_distribution<double> spot_X(bench_Size.width * 0.25, bench_Size.width * 0.75);
+                std::uniform_real_distribution<double> spot_Y(bench_Size.height * 0.25, bench_Size.height * 0.75);
+                LD_Camera::Frame_Replay my_Replay;
+                std::vector<double> true_X(n_Frames), true_Y(n_Frames);
+                for (int i=0; i < n_Frames; i++){
+                    LD_Camera::Synthetic_Options options =
+                        LD_Camera::Default_Synthetic(bench_Size.width, bench_Size.height, bits_Per_Pixel);
+                    options.sigma = sigma;
+                    options.spot_X = true_X[i] = spot_X(random_Engine);
+                    options.spot_Y = true_Y[i] = spot_Y(random_Engine);
+                    my_Replay.Add_Frame(LD_Camera::Make_Synthetic_Frame(options, random_Engine),
+                                        bench_Size.width, bench_Size.height, bits_Per_Pixel);
+                }
+                std::vector<LD_Camera::Frame_View> frames;
+                for (int i=0; i < n_Frames; i++){
+                    frames.push_back(my_Replay.Next_Frame());
+                }
+                double frame_Bytes = (double)frames[0].stride * frames[0].height;
+                double unpacked_Bytes = sizeof(uint16_t) * bench_Size.width * bench_Size.height;
+                double projection_Bytes = sizeof(uint64_t) * (bench_Size.width + bench_Size.height);
+
+                // Time a stage over every frame, and how far out found_X/Y
+                // are (if it fills them in).
+                std::vector<double> found_X(n_Frames), found_Y(n_Frames);
+                auto run_Stage = [&](std::string stage, double bytes, bool has_Position,
+                                     std::function<void(int)> my_Stage){
+                    double ns = Time_Per_Call([&](){
+                        for (int i=0; i < n_Frames; i++){
+                            my_Stage(i);
+                        }
+                    }, 0.1) / n_Frames;
+                    double error = -1;
+                    if (has_Position){
+                        double total_Squared = 0;
+                        for (int i=0; i < n_Frames; i++){
+                            double distance = std::hypot(found_X[i] - true_X[i], found_Y[i] - true_Y[i]);
+                            total_Squared += distance * distance;
+                        }
+                        error = std::sqrt(total_Squared / n_Frames);
+                    }
+                    Stage_Result result = {stage, bench_Size.width, bench_Size.height, bits_Per_Pixel, sigma,
+                                           ns, 1e9 * bytes / ns, error};
+                    results.push_back(result);
+                    std::cout << (bits_Per_Pixel > 8 ? "MONO16 " : "MONO8  ")
+                              << std::setw(4) << bench_Size.width << "x" << std::setw(4) << bench_Size.height
+                              << " sigma " << std::fixed << std::setprecision(1) << sigma << " "
+                              << std::left << std::setw(25) << stage << std::right << ": "
+                              << std::setprecision(2)
+                              << std::setw(9) << ns / 1000 << " us/frame, "
+                              << std::setw(7) << bytes / ns << " GB/s";
+                    if (has_Position){
+                        std::cout << ", rms error " << std::setprecision(4) << error << " px";
+                    }
+                    std::cout << "\n";
+                };
+                auto check = [&](std::string stage, bool ok, std::string problem){
+                    if (!ok){
+                        std::cout << stage << " " << problem << "!" << "\n";
+                        n_Errors++;
+                    }
+                };
+                // For the stage just run.
+                auto check_Error = [&](double limit){
+                    check(results.back().stage, results.back().centroid_Error <= limit,
+                          "rms error over " + std::to_string(limit) + " px");
+                };
+
+                // Unpacking to uint16_t, what Camera::Copy_Memory does, at
+                // each SIMD level the CPU has. Every level has to match the
+                // plain one, whose output project_original uses.
+                std::vector<std::vector<uint16_t>> unpacked(n_Frames), simd_Unpacked(n_Frames);
+                for (int level = LD_Simd::SIMD_NONE; level <= best_Level; level++){
+                    LD_Simd::Simd_Level my_Level = (LD_Simd::Simd_Level)level;
+                    std::vector<std::vector<uint16_t>>& output =
+                        (my_Level == LD_Simd::SIMD_NONE) ? unpacked : simd_Unpacked;
+                    std::string stage = Level_Stage("unpack", my_Level);
+                    run_Stage(stage, frame_Bytes, false, [&](int i){
+                        output[i].resize(frames[i].Num_Pixels());
+                        if (bits_Per_Pixel > 8){
+                            LD_Camera::Unpack_Mono16(frames[i].data, output[i].data(), frames[i].Num_Pixels(),
+                                                     frames[i].Shift(), my_Level);
+                        }
+                        else{
+                            LD_Camera::Unpack_Mono8(frames[i].data, output[i].data(), frames[i].Num_Pixels(),
+                                                    my_Level);
+                        }
+                    });
+                    if (my_Level != LD_Simd::SIMD_NONE){
+                        check(stage, simd_Unpacked == unpacked, "disagrees with the scalar version");
+                    }
+                }
+
+                // The projections, all centroided the same way. Every one
+                // is checked against the reference.
+                Projection_Set reference(n_Frames), projected(n_Frames);
+                LD_QuarcTracker::Projection_Scratch scratch;
+                auto centroid_Projections = [&](int i){
+                    found_X[i] = LD_QuarcTracker::Thresholded_Centroid(projected.cols[i], gaussian_Thresh);
+                    found_Y[i] = LD_QuarcTracker::Thresholded_Centroid(projected.rows[i], gaussian_Thresh);
+                };
+                auto check_Projections = [&](std::string stage, const Projection_Set& expected){
+                    check(stage, Same_Projections(projected, expected), "disagrees with Project_Reference");
+                };
+                run_Stage("project_reference", frame_Bytes, true, [&](int i){
+                    reference.stats[i] = LD_QuarcTracker::Project_Reference(frames[i], peak_Thresh, reference.rows[i],
+                                                                            reference.cols[i]);
+                    found_X[i] = LD_QuarcTracker::Thresholded_Centroid(reference.cols[i], gaussian_Thresh);
+                    found_Y[i] = LD_QuarcTracker::Thresholded_Centroid(reference.rows[i], gaussian_Thresh);
+                });
+                double reference_Error = results.back().centroid_Error;
+                // The loop as it was before the frame views and kernels. It
+                // doesn't work out the rest of the stats, so only the totals
+                // can be checked.
+                run_Stage("project_original", unpacked_Bytes, true, [&](int i){
+                    projected.stats[i] = Project_Original(unpacked[i], bench_Size.width, peak_Thresh,
+                                                          projected.rows[i], projected.cols[i]);
+                    centroid_Projections(i);
+                });
+                check("project_original", (projected.rows == reference.rows) && (projected.cols == reference.cols),
+                      "disagrees with Project_Reference");
+                // Ends up back at the best level for everything after.
+                for (int level = LD_Simd::SIMD_NONE; level <= best_Level; level++){
+                    LD_Simd::Set_Simd_Level((LD_Simd::Simd_Level)level);
+                    std::string stage = Level_Stage("project_fused", (LD_Simd::Simd_Level)level);
+                    run_Stage(stage, frame_Bytes, true, [&](int i){
+                        projected.stats[i] = LD_QuarcTracker::Project_Fused(frames[i], peak_Thresh, projected.rows[i],
+                                                                            projected.cols[i], scratch);
+                        centroid_Projections(i);
+                    });
+                    check_Projections(stage, reference);
+                }
+                run_Stage("project_fixed", frame_Bytes, true, [&](int i){
+                    projected.stats[i] = LD_QuarcTracker::Project_Fixed(frames[i], peak_Thresh, projected.rows[i],
+                                                                        projected.cols[i], scratch);
+                    centroid_Projections(i);
+                });
+                check_Projections("project_fixed", reference);
+                // Every frame's maximum is predicted from the one before, as
+                // it is when tracking.
+                uint16_t last_Max_Pixel = 0;
+                run_Stage("project_predicted", frame_Bytes, true, [&](int i){
+                    last_Max_Pixel = LD_QuarcTracker::Project_Predicted(frames[i], peak_Thresh, last_Max_Pixel, 0.1,
+                                                                        projected.rows[i], projected.cols[i],
+                                                                        scratch).max_Pixel;
+                    centroid_Projections(i);
+                });
+                // A guess far enough out to rescan every frame, which makes
+                // it exact.
+                run_Stage("project_rescan", frame_Bytes, true, [&](int i){
+                    projected.stats[i] = LD_QuarcTracker::Project_Predicted(frames[i], peak_Thresh,
+                                                                            reference.stats[i].max_Pixel / 2, 0.1,
+                                                                            projected.rows[i], projected.cols[i],
+                                                                            scratch);
+                    centroid_Projections(i);
+                });
+                check_Projections("project_rescan", reference);
+
+                // With the corrections, checked against Project_Reference
+                // making the same ones. The background is learnt from the
+                // dark frames, as a saved model would have been.
+                LD_QuarcTracker::Background_Model background;
+                background.Reset(dark_Frames[0]);
+                for (auto& dark_Frame : dark_Frames){
+                    background.Update(dark_Frame, 6, 0, 0, 0, 0);
+                }
+                // Later updates leave out a square round the spot.
+                const int skip_Size = 32;
+                run_Stage("background_update", frame_Bytes, false, [&](int i){
+                    background.Update(dark_Frames[i], 6, std::lround(true_X[i]) - (skip_Size / 2),
+                                      std::lround(true_Y[i]) - (skip_Size / 2), skip_Size, skip_Size);
+                });
+                LD_QuarcTracker::Adaptive_Thresh adaptive = {true, 5};
+
+                auto reference_With = [&](LD_QuarcTracker::Pixel_Corrections corrections,
+                                          LD_QuarcTracker::Adaptive_Thresh my_Adaptive){
+                    Projection_Set expected(n_Frames);
+                    for (int i=0; i < n_Frames; i++){
+                        expected.stats[i] = LD_QuarcTracker::Project_Reference(frames[i], peak_Thresh, expected.rows[i],
+                                                                               expected.cols[i], corrections,
+                                                                               my_Adaptive);
+                    }
+                    return expected;
+                };
+                Projection_Set subtracted = reference_With({&background, nullptr}, LD_QuarcTracker::Adaptive_Thresh());
+                run_Stage("project_subtracted", frame_Bytes, true, [&](int i){
+                    projected.stats[i] = LD_QuarcTracker::Project_Fused(frames[i], peak_Thresh, projected.rows[i],
+                                                                        projected.cols[i], scratch,
+                                                                        {&background, nullptr});
+                    centroid_Projections(i);
+                });
+                check_Projections("project_subtracted", subtracted);
+                run_Stage("project_fixed_subtracted", frame_Bytes, true, [&](int i){
+                    projected.stats[i] = LD_QuarcTracker::Project_Fixed(frames[i], peak_Thresh, projected.rows[i],
+                                                                        projected.cols[i], scratch,
+                                                                        {&background, nullptr});
+                    centroid_Projections(i);
+                });
+                check_Projections("project_fixed_subtracted", subtracted);
+                Projection_Set corrected = reference_With({nullptr, &pixel_Map}, LD_QuarcTracker::Adaptive_Thresh());
+                run_Stage("project_corrected", frame_Bytes, true, [&](int i){
+                    projected.stats[i] = LD_QuarcTracker::Project_Fused(frames[i], peak_Thresh, projected.rows[i],
+                                                                        projected.cols[i], scratch,
+                                                                        {nullptr, &pixel_Map});
+                    centroid_Projections(i);
+                });
+                check_Projections("project_corrected", corrected);
+                Projection_Set thresholded = reference_With(no_Corrections, adaptive);
+                run_Stage("project_adaptive", frame_Bytes, true, [&](int i){
+                    projected.stats[i] = LD_QuarcTracker::Project_Fused(frames[i], peak_Thresh, projected.rows[i],
+                                                                        projected.cols[i], scratch,
+                                                                        no_Corrections, adaptive);
+                    centroid_Projections(i);
+                });
+                check_Projections("project_adaptive", thresholded);
+
+                // The searches that narrow down where to project. The
+                // pyramid's window round the brightest block has to have the
+                // brightest pixel in.
+                const int search_Window = 128;
+                LD_QuarcTracker::Pyramid_Image pyramid_Image;
+                run_Stage("pyramid_search", frame_Bytes, true, [&](int i){
+                    int x, y;
+                    LD_QuarcTracker::Build_Pyramid(frames[i], 8, pyramid_Image);
+                    LD_QuarcTracker::Brightest_Block(pyramid_Image, x, y);
+                    LD_Camera::Frame_View window = frames[i].Sub_View(x - (search_Window / 2), y - (search_Window / 2),
+                                                                      search_Window, search_Window);
+                    projected.stats[i] = LD_QuarcTracker::Project_Fused(window, peak_Thresh, projected.rows[i],
+                                                                        projected.cols[i], scratch);
+                    centroid_Projections(i);
+                    found_X[i] += window.offset_X - frames[i].offset_X;
+                    found_Y[i] += window.offset_Y - frames[i].offset_Y;
+                });
+                for (int i=0; i < n_Frames; i++){
+                    if (projected.stats[i].max_Pixel != reference.stats[i].max_Pixel){
+                        check("pyramid_search", false, "missed the brightest pixel");
+                        break;
+                    }
+                }
+                // The summed-area table, centroided from the brightest
+                // window with the pixels under the peak threshold taken off.
+                // Not one of the spot finder's searches: building the table
+                // costs more than projecting the whole frame, it's for
+                // scoring lots of windows.
+                const int integral_Window = 32;
+                uint16_t floor = peak_Thresh * max_Value;
+                LD_QuarcTracker::Integral_Image integral_Image;
+                std::vector<int> window_X(n_Frames), window_Y(n_Frames);
+                std::vector<uint64_t> window_Totals(n_Frames);
+                run_Stage("integral_search", frame_Bytes, true, [&](int i){
+                    integral_Image.Build(frames[i], floor, no_Corrections);
+                    integral_Image.Brightest_Window(integral_Window, integral_Window, integral_Window / 4,
+                                                    window_X[i], window_Y[i]);
+                    LD_QuarcTracker::Window_Moments moments = integral_Image.Window(window_X[i], window_Y[i],
+                                                                                    integral_Window,
+                                                                                    integral_Window);
+                    window_Totals[i] = moments.total;
+                    found_X[i] = moments.x;
+                    found_Y[i] = moments.y;
+                });
+                for (int i=0; i < n_Frames; i++){
+                    // Added up the slow way.
+                    uint64_t total = 0;
+                    for (int y=window_Y[i]; y < std::min(window_Y[i] + integral_Window, bench_Size.height); y++){
+                        for (int x=window_X[i]; x < std::min(window_X[i] + integral_Window, bench_Size.width); x++){
+                            total += std::max(frames[i].Pixel(x, y), floor) - floor;
+                        }
+                    }
+                    if (total != window_Totals[i]){
+                        check("integral_search", false, "window total disagrees with the pixels");
+                        break;
+                    }
+                }
+                // What a candidate search costs once the table's built, 1000
+                // windows all over the last frame.
+                const int n_Windows = 1000;
+                std::vector<int> random_X(n_Windows), random_Y(n_Windows);
+                for (int i=0; i < n_Windows; i++){
+                    random_X[i] = random_Engine() % bench_Size.width;
+                    random_Y[i] = random_Engine() % bench_Size.height;
+                }
+                uint64_t checksum = 0;
+                run_Stage("integral_1000_windows", 0, false, [&](int){
+                    for (int i=0; i < n_Windows; i++){
+                        checksum += integral_Image.Window_Total(random_X[i], random_Y[i], integral_Window,
+                                                                integral_Window);
+                    }
+                });
+                LD_QuarcTracker::Sparse_Grid grid;
+                int stride = LD_QuarcTracker::Sparse_Stride(2 * std::sqrt(2 * std::log(2.0)) * sigma);
+                // Only where the spot finder would use it, on the full frame
+                // with the samples far enough apart.
+                if (full_Frame && (stride >= LD_QuarcTracker::sparse_Min_Stride)){
+                    run_Stage("sparse_search", frame_Bytes, true, [&](int i){
+                        int x, y, width, height;
+                        found_X[i] = -1;
+                        found_Y[i] = -1;
+                        LD_QuarcTracker::Sample_Grid(frames[i], stride, no_Corrections, grid);
+                        if (LD_QuarcTracker::Candidate_Box(grid, peak_Thresh, LD_QuarcTracker::abs_Thresh,
+                                                           x, y, width, height)){
+                            LD_Camera::Frame_View box = frames[i].Sub_View(x, y, width, height);
+                            LD_QuarcTracker::Project_Fused(box, peak_Thresh, projected.rows[i], projected.cols[i],
+                                                           scratch);
+                            centroid_Projections(i);
+                            found_X[i] += box.offset_X - frames[i].offset_X;
+                            found_Y[i] += box.offset_Y - frames[i].offset_Y;
+                        }
+                    });
+                    // The box leaves out anything over the threshold away from
+                    // the spot, so can do better than the whole frame but
+                    // shouldn't do worse.
+                    check_Error(reference_Error + 0.01);
+                }
+                std::vector<LD_QuarcTracker::Blob> blobs;
+                LD_QuarcTracker::Blob_Scratch blob_Scratch;
+                run_Stage("blobs", frame_Bytes, true, [&](int i){
+                    LD_QuarcTracker::Find_Blobs(frames[i], peak_Thresh, blobs, blob_Scratch);
+                    int chosen = LD_QuarcTracker::Choose_Blob(blobs, LD_QuarcTracker::RANK_BRIGHTEST, 5, 1500,
+                                                              false, 0, 0, 0);
+                    found_X[i] = (chosen >= 0) ? blobs[chosen].x : -1;
+                    found_Y[i] = (chosen >= 0) ? blobs[chosen].y : -1;
+                });
+                check_Error(0.5);
+
+                // The estimators, on the reference projections. The ones
+                // that are meant to beat the centroid at least have to beat
+                // taking the middle of the peak bin, which is out by
+                // 1/sqrt(6) px rms. The centroid doesn't always, noise over
+                // the threshold in the tails of a small spot drags it about.
+                double peak_Bin_Limit = 0.75 / std::sqrt(6.0);
+                run_Stage("centroid", projection_Bytes, true, [&](int i){
+                    found_X[i] = LD_QuarcTracker::Thresholded_Centroid(reference.cols[i], gaussian_Thresh);
+                    found_Y[i] = LD_QuarcTracker::Thresholded_Centroid(reference.rows[i], gaussian_Thresh);
+                });
+                double centroid_Error = results.back().centroid_Error;
+                int half_Width = std::ceil(3 * sigma);
+                run_Stage("windowed", projection_Bytes, true, [&](int i){
+                    found_X[i] = LD_QuarcTracker::Windowed_Centroid(reference.cols[i], half_Width);
+                    found_Y[i] = LD_QuarcTracker::Windowed_Centroid(reference.rows[i], half_Width);
+                });
+                check_Error(peak_Bin_Limit);
+                run_Stage("parabolic", projection_Bytes, true, [&](int i){
+                    found_X[i] = LD_QuarcTracker::Parabolic_Peak(reference.cols[i]);
+                    found_Y[i] = LD_QuarcTracker::Parabolic_Peak(reference.rows[i]);
+                });
+                check_Error(peak_Bin_Limit);
+                run_Stage("gauss_3point", projection_Bytes, true, [&](int i){
+                    found_X[i] = LD_QuarcTracker::Gaussian_Peak(reference.cols[i]);
+                    found_Y[i] = LD_QuarcTracker::Gaussian_Peak(reference.rows[i]);
+                });
+                check_Error(peak_Bin_Limit);
+
+                // The gaussian fit of a window round the centroid, sticking
+                // with the centroid if the fit wanders off like the tracker
+                // does.
+                const int fit_Window = 32;
+                LD_QuarcTracker::Gauss_Fit_Scratch fit_Scratch;
+                run_Stage("gauss_fit", fit_Window * fit_Window * frames[0].Bytes_Per_Pixel(), true, [&](int i){
+                    double centre_X = LD_QuarcTracker::Thresholded_Centroid(reference.cols[i], gaussian_Thresh);
+                    double centre_Y = LD_QuarcTracker::Thresholded_Centroid(reference.rows[i], gaussian_Thresh);
+                    LD_Camera::Frame_View window = frames[i].Sub_View(std::lround(centre_X) - (fit_Window / 2),
+                                                                      std::lround(centre_Y) - (fit_Window / 2),
+                                                                      fit_Window, fit_Window);
+                    LD_QuarcTracker::Gauss_Params seed =
+                        LD_QuarcTracker::Seed_Gaussian(window, centre_X - (window.offset_X - frames[i].offset_X),
+                                                       centre_Y - (window.offset_Y - frames[i].offset_Y),
+                                                       fit_Scratch);
+                    LD_QuarcTracker::Gauss_Fit_Result fit = LD_QuarcTracker::Fit_Gaussian(window, seed, 20,
+                                                                                           fit_Scratch);
+                    if (!LD_QuarcTracker::Fit_Believable(fit, seed)){
+                        fit.params = seed;
+                    }
+                    found_X[i] = fit.params.x0 + (window.offset_X - frames[i].offset_X);
+                    found_Y[i] = fit.params.y0 + (window.offset_Y - frames[i].offset_Y);
+                });
+                // It starts from the centroid so should never end up further
+                // out than it.
+                check_Error(std::max(centroid_Error, 0.1));
+            }
+        }
+    }
+    return n_Errors;
+}
+
+int Write_Results_CSV(const std::vector<Stage_Result>& results, std::string file_Name){
+    std::ofstream out_File(file_Name);
+    if (!out_File){
+        std::cout << "Couldn't write " << file_Name << "\n";
+        return 1;
+    }
+    out_File << "Stage, Width, Height, Bits Per Pixel, Sigma, ns/frame, Bytes/s, Centroid Error (px)\n";
+    for (auto& result : results){
+        out_File << result.stage << ", " <<
+            result.width << ", " <<
+            result.height << ", " <<
+            result.bits_Per_Pixel << ", " <<
+            result.sigma << ", " <<
+            result.ns_Per_Frame << ", " <<
+            result.bytes_Per_Second << ", " <<
+            result.centroid_Error << "\n";
+    }
+    std::cout << "Results saved to " << file_Name << "\n";
+    return 0;
+}
+
+int Write_Results_JSON(const std::vector<Stage_Result>& results, std::string file_Name){
+    std::ofstream out_File(file_Name);
+    if (!out_File){
+        std::cout << "Couldn't write " << file_Name << "\n";
+        return 1;
+    }
+    out_File << "{\n  \"simd\": \"" << LD_Simd::Simd_Level_Name(LD_Simd::Get_Simd_Level()) << "\",\n"
+             << "  \"results\": [\n";
+    for (unsigned int i=0; i < results.size(); i++){
+        const Stage_Result& result = results[i];
+        out_File << "    {\"stage\": \"" << result.stage << "\", " <<
+            "\"width\": " << result.width << ", " <<
+            "\"height\": " << result.height << ", " <<
+            "\"bits_Per_Pixel\": " << result.bits_Per_Pixel << ", " <<
+            "\"sigma\": " << result.sigma << ", " <<
+            "\"ns_Per_Frame\": " << result.ns_Per_Frame << ", " <<
+            "\"bytes_Per_Second\": " << result.bytes_Per_Second << ", " <<
+            "\"centroid_Error\": " << result.centroid_Error << "}" <<
+            ((i + 1 < results.size()) ? "," : "") << "\n";
+    }
+    out_File << "  ]\n}\n";
+    std::cout << "Results saved to " << file_Name << "\n";
+    return 0;
+}
@@ -0,0 +1,228 @@
+#include "LD_Blobs.h"
+#include "LD_SpotKernels.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace LD_QuarcTracker{
+    namespace{
+        typedef Blob_Scratch::Run Run;
+        typedef Blob_Scratch::Label Label;
+
+        int Find_Root(std::vector<Label>& labels, int label){
+            while (labels[label].parent != label){
+                // Path halving, keeps the trees flat.
+                labels[label].parent = labels[labels[label].parent].parent;
+                label = labels[label].parent;
+            }
+            return label;
+        }
+
+        void Join(std::vector<Label>& labels, int a, int b){
+            a = Find_Root(labels, a);
+            b = Find_Root(labels, b);
+            if (a != b){
+                labels[std::max(a, b)].parent = std::min(a, b);
+            }
+        }
+
+        void Merge_Into(Label& root, const Label& other){
+            root.blob.area += other.blob.area;
+            root.blob.total += other.blob.total;
+            root.blob.peak = std::max(root.blob.peak, other.blob.peak);
+            root.blob.min_X = std::min(root.blob.min_X, other.blob.min_X);
+            root.blob.min_Y = std::min(root.blob.min_Y, other.blob.min_Y);
+            root.blob.max_X = std::max(root.blob.max_X, other.blob.max_X);
+            root.blob.max_Y = std::max(root.blob.max_Y, other.blob.max_Y);
+            root.total_X += other.total_X;
+            root.total_Y += other.total_Y;
+            root.total_XX += other.total_XX;
+            root.total_YY += other.total_YY;
+            root.total_XY += other.total_XY;
+        }
+
+        // Cut one line into runs of pixels over thresh, each with its own
+        // new label.
+        void Encode_Line(const uint16_t* line, int width, int row, uint16_t thresh,
+                         std::vector<Run>& runs, std::vector<Label>& labels){
+            runs.clear();
+            int col = 0;
+            while (col < width){
+                if (line[col] <= thresh){
+                    col++;
+                    continue;
+                }
+                Label new_Label = {(int)labels.size(), {0, 0, 0, 0, 0, col, row, col, row, 0, 0, 0},
+                                   0, 0, 0, 0, 0};
+                Blob& blob = new_Label.blob;
+                for(; (col < width) && (line[col] > thresh); col++){
+                    blob.area++;
+                    blob.total += line[col];
+                    blob.peak = std::max(blob.peak, line[col]);
+                    new_Label.total_X += (uint64_t)line[col] * col;
+                    new_Label.total_XX += (uint64_t)line[col] * col * col;
+                }
+                blob.max_X = col - 1;
+                // Everything in the run is on the same row.
+                new_Label.total_Y = blob.total * row;
+                new_Label.total_YY = new_Label.total_Y * row;
+                new_Label.total_XY = new_Label.total_X * row;
+                runs.push_back({blob.min_X, blob.max_X, new_Label.parent});
+                labels.push_back(new_Label);
+            }
+        }
+
+        // Join runs which touch a run on the line above (diagonals count).
+        // Both lists are in order left to right.
+        void Join_Runs(const std::vector<Run>& last_Runs, const std::vector<Run>& runs,
+                       std::vector<Label>& labels){
+            unsigned int i = 0;
+            unsigned int j = 0;
+            while ((i < last_Runs.size()) && (j < runs.size())){
+                const Run& above = last_Runs[i];
+                const Run& run = runs[j];
+                if ((above.start <= run.end + 1) && (run.start <= above.end + 1)){
+                    Join(labels, above.label, run.label);
+                }
+                // Move on whichever finishes first, it can't touch anything
+                // further right.
+                if (above.end < run.end){
+                    i++;
+                }
+                else{
+                    j++;
+                }
+            }
+        }
+    } // namespace
+
+    uint16_t Find_Blobs(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                        std::vector<Blob>& blobs, Blob_Scratch& scratch,
+                        const Pixel_Corrections& corrections, Projection_Stats* stats,
+                        const Adaptive_Thresh& adaptive){
+        blobs.clear();
+        if (stats){
+            *stats = {0, 0, 0, false, 0, 0, 0, 0};
+        }
+        if (!my_Frame.Valid()){
+            return 0;
+        }
+
+        // Threshold the same way as the projections.
+        scratch.row_Max.resize(my_Frame.height);
+        Row_Sums zero = {0, 0, 0};
+        scratch.row_Sums.assign(stats ? my_Frame.height : 0, zero);
+        Pixel_Histogram* histogram = nullptr;
+        if (adaptive.enabled){
+            Reset_Histogram(scratch.histogram, my_Frame.bits_Per_Pixel);
+            histogram = &scratch.histogram;
+        }
+        Projection_Stats frame_Stats = {0, 0, 0, false, 0, 0, 0, 0};
+        int row_Step = Histogram_Row_Step(my_Frame);
+        for(int row=0; row < my_Frame.height; row++){
+            scratch.row_Max[row] = Corrected_Row_Max(my_Frame, row, Corrections_For_Row(corrections, my_Frame, row),
+                                                     stats ? &scratch.row_Sums[row] : nullptr,
+                                                     (row % row_Step) ? nullptr : histogram);
+            frame_Stats.max_Pixel = std::max(frame_Stats.max_Pixel, scratch.row_Max[row]);
+        }
+        if (histogram){
+            Finish_Histogram(*histogram);
+        }
+        uint16_t thresh = Pick_Threshold(histogram, peak_Thresh, adaptive, frame_Stats);
+
+        scratch.line.resize(my_Frame.width);
+        scratch.labels.clear();
+        scratch.last_Runs.clear();
+        for(int row=0; row < my_Frame.height; row++){
+            if (scratch.row_Max[row] <= thresh){
+                // Nothing to join to on the next line.
+                scratch.last_Runs.clear();
+                continue;
+            }
+            Corrected_Row(my_Frame, row, Corrections_For_Row(corrections, my_Frame, row), scratch.line.data());
+            Encode_Line(scratch.line.data(), my_Frame.width, row, thresh, scratch.runs, scratch.labels);
+            Join_Runs(scratch.last_Runs, scratch.runs, scratch.labels);
+            std::swap(scratch.runs, scratch.last_Runs);
+        }
+
+        // Roots always have the lowest label in their blob, so going in
+        // order every label is merged after its root has been seen.
+        std::vector<Label>& labels = scratch.labels;
+        for(unsigned int label=0; label < labels.size(); label++){
+            int root = Find_Root(labels, label);
+            if (root != (int)label){
+                Merge_Into(labels[root], labels[label]);
+            }
+        }
+        for(unsigned int label=0; label < labels.size(); label++){
+            if (labels[label].parent == (int)label){
+                const Label& root = labels[label];
+                Blob blob = root.blob;
+                blob.x = (double)root.total_X / blob.total;
+                blob.y = (double)root.total_Y / blob.total;
+                blob.var_X = ((double)root.total_XX / blob.total) - (blob.x * blob.x);
+                blob.var_Y = ((double)root.total_YY / blob.total) - (blob.y * blob.y);
+                blob.cov_XY = ((double)root.total_XY / blob.total) - (blob.x * blob.y);
+                blobs.push_back(blob);
+            }
+        }
+
+        if (stats){
+            for(const Blob& blob : blobs){
+                frame_Stats.n_Peak_Pixels += blob.area;
+            }
+            Background_Stats(my_Frame, scratch.row_Max, scratch.row_Sums, thresh, frame_Stats);
+            *stats = frame_Stats;
+        }
+        return thresh;
+    }
+
+    Blob_Ranking Blob_Ranking_From_Name(std::string name){
+        if (name == "nearest"){
+            return RANK_NEAREST;
+        }
+        if (name == "area"){
+            return RANK_AREA;
+        }
+        if (name != "brightest"){
+            std::cout << "Unknown blob ranking " << name << ", using brightest" << "\n";
+        }
+        return RANK_BRIGHTEST;
+    }
+
+    int Choose_Blob(const std::vector<Blob>& blobs, Blob_Ranking ranking, int min_Area, int max_Area,
+                    bool have_Last, double last_X, double last_Y, int expected_Area){
+        if ((ranking == RANK_NEAREST) && !have_Last){
+            ranking = RANK_BRIGHTEST;
+        }
+
+        int best = -1;
+        double best_Score = 0;
+        for(unsigned int i=0; i < blobs.size(); i++){
+            const Blob& blob = blobs[i];
+            if ((blob.area < min_Area) || (blob.area > max_Area)){
+                continue;
+            }
+            // Lower is better.
+            double score = 0;
+            switch (ranking){
+                case RANK_BRIGHTEST:
+                    score = -(double)blob.peak;
+                    break;
+                case RANK_NEAREST:
+                    score = (blob.x - last_X) * (blob.x - last_X) + (blob.y - last_Y) * (blob.y - last_Y);
+                    break;
+                case RANK_AREA:
+                    score = std::abs(blob.area - expected_Area);
+                    break;
+            }
+            if ((best < 0) || (score < best_Score)){
+                best = i;
+                best_Score = score;
+            }
+        }
+        return best;
+    }
+
+} // namespace LD_QuarcTracker
@@ -1,10 +1,23 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 
 
 #include "LD_Camera.h"
+#include "LD_PixelKernels.h"
 
 namespace LD_Camera{
+    namespace{
+        // Added to by Count_Image_Copy.
+        std::atomic<uint64_t> image_Copies(0);
+    } // namespace
+
+    void Count_Image_Copy(){
+        image_Copies.fetch_add(1, std::memory_order_relaxed);
+    }
+
     int FindCameras(){
         int num_Cameras = 0;
         is_GetNumberOfCameras(&num_Cameras);
@@ -38,6 +51,14 @@ namespace LD_Camera{
     Camera::~Camera()
     {
         //dtor
+        if (is_Connected && continuous_Capture){
+            Stop_Capture();
+            is_DisableEvent(m_hG, IS_SET_EVENT_FRAME);
+            #ifdef _WIN32
+            is_ExitEvent(m_hG, IS_SET_EVENT_FRAME);
+            CloseHandle(frame_Event);
+            #endif // _WIN32
+        }
     }
 
     int Camera::Init(CameraOptions my_Options){
@@ -89,20 +110,40 @@ namespace LD_Camera{
         }
         std::cout << "Set colour mode says: " << m_Ret << "\n";
 
-        // Rather than free running. Quite a bit faster!
-        is_SetExternalTrigger(m_hG, IS_SET_TRIGGER_SOFTWARE);
+        // Software trigger rather than free running unless asked otherwise.
+        // Capturing one frame at a time is quite a bit faster than the
+        // default free running setup, but in continuous mode the next
+        // exposure overlaps with processing this one which is faster still.
+        continuous_Capture = my_Options.continuous_Capture;
+        if (continuous_Capture){
+            is_SetExternalTrigger(m_hG, IS_SET_TRIGGER_OFF);
+            #ifdef _WIN32
+            frame_Event = CreateEvent(NULL, FALSE, FALSE, NULL);
+            is_InitEvent(m_hG, frame_Event, IS_SET_EVENT_FRAME);
+            #endif // _WIN32
+            is_EnableEvent(m_hG, IS_SET_EVENT_FRAME);
+        }
+        else{
+            is_SetExternalTrigger(m_hG, IS_SET_TRIGGER_SOFTWARE);
+        }
 
-        // Allocate image memories.
-        is_AllocImageMem(m_hG, sInfo.nMaxWidth, sInfo.nMaxHeight, m_nBitsPerPixel,
-                            &frame_Memory.buffer, &frame_Memory.id);
-        is_AllocImageMem(m_hG, my_AOI.aoi_Size.s32Width, my_AOI.aoi_Size.s32Height, m_nBitsPerPixel,
-                            &aoi_Memory.buffer, &aoi_Memory.id);
+        // Allocate rings of image memories. The driver captures into them
+        // in turn and skips any that are locked (ie. being read by us).
+        n_Buffers = my_Options.n_Buffers;
+        if (n_Buffers < 2){
+            n_Buffers = 2;
+        }
+        // When free running, one buffer is locked by us and the driver needs
+        // at least two more to alternate between.
+        if (continuous_Capture && (n_Buffers < 3)){
+            n_Buffers = 3;
+        }
+        Alloc_Ring(frame_Ring, sInfo.nMaxWidth, sInfo.nMaxHeight);
+        Alloc_Ring(aoi_Ring, my_AOI.aoi_Size.s32Width, my_AOI.aoi_Size.s32Height);
         // set memory active
-        is_SetImageMem(m_hG, frame_Memory.buffer, frame_Memory.id);
+        Activate_Ring(frame_Ring);
 
-        // Make some vectors to copy the horrible image memories to.
-        // TODO: experiment if this can be done directly by passing
-        // vector.data instead of &Camera_Memory.buffer...
+        // Vectors to unpack the horrible image memories to, if anyone asks.
         full_Image_Data.resize(full_Frame.aoi_Size.s32Width * full_Frame.aoi_Size.s32Height, 0);
         aoi_Image_Data.resize(my_AOI.aoi_Size.s32Width * my_AOI.aoi_Size.s32Height, 0);
 
@@ -120,6 +161,15 @@ namespace LD_Camera{
         aoi_Exposure = default_AOI_Exposure;
         Set_Exposure(default_Exposure);
 
+        // Bad pixels found last time the sensor was calibrated.
+        pixel_Map_File = my_Options.pixel_Map_File;
+        if (!pixel_Map_File.empty()){
+            pixel_Map.Load(pixel_Map_File);
+        }
+
+        // Does nothing unless in continuous mode.
+        Start_Capture();
+
         is_Initted = true;
         std::cout << "Camera ready" << "\n";
 
@@ -182,18 +232,56 @@ namespace LD_Camera{
     int Camera::Take_Picture(){
         //std::cout << "Take picture" << "\n";
         if (is_Connected && is_Initted){
-            // Capture image into memory buffer.
-            m_Ret = is_FreezeVideo(m_hG, IS_WAIT);
-            if (m_Ret != IS_SUCCESS) {
-                std::cout << "Fail. Camera says: " << m_Ret << "\n";
+            // The previous frame is finished with, let the driver have its
+            // memory back. Its view goes too, so nothing reads the buffer if
+            // there's no new frame to replace it.
+            Release_Frame();
+            current_Frame.data = nullptr;
+
+            Camera_Memory* newest_Memory;
+            if (continuous_Capture){
+                // The camera is free running so it has probably already
+                // exposed the next frame while we were busy with the last.
+                newest_Memory = Wait_For_New_Frame();
+            }
+            else{
+                // Capture image into the next memory buffer in the ring.
+                m_Ret = is_FreezeVideo(m_hG, IS_WAIT);
+                if (m_Ret != IS_SUCCESS) {
+                    std::cout << "Fail. Camera says: " << m_Ret << "\n";
+                    return 1;
+                }
+                newest_Memory = Newest_Memory();
+            }
+
+            if (newest_Memory == nullptr){
+                std::cout << "Fail. No new frame from camera" << "\n";
                 return 1;
             }
 
-            if(aoi_Set){
-                Copy_Memory(aoi_Memory, aoi_Image_Data);
+            // Lock the buffer the driver just finished writing so it doesn't
+            // get overwritten while it's being used.
+            is_LockSeqBuf(m_hG, IS_IGNORE_PARAMETER, newest_Memory->buffer);
+            locked_Buffer = newest_Memory->buffer;
+
+            AOI &active_AOI = aoi_Set ? my_AOI : full_Frame;
+            current_Frame.data = (const uint8_t*)newest_Memory->buffer;
+            current_Frame.width = newest_Memory->width;
+            current_Frame.height = newest_Memory->height;
+            current_Frame.stride = newest_Memory->pitch;
+            current_Frame.offset_X = active_AOI.aoi_Position.s32X;
+            current_Frame.offset_Y = active_AOI.aoi_Position.s32Y;
+            current_Frame.bits_Per_Pixel = m_nBitsPerPixel;
+            current_Frame.frame_ID = ++frame_Counter;
+            if (continuous_Capture){
+                // Camera's timestamp is in 0.1us, and is when the frame was
+                // actually exposed rather than when we got round to it.
+                current_Frame.capture_Time = last_Frame_Timestamp * 1e-7;
             }
             else{
-                Copy_Memory(frame_Memory, full_Image_Data);
+                // is_FreezeVideo only just returned with it.
+                current_Frame.capture_Time = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
             }
         }
         else{
@@ -203,40 +291,226 @@ namespace LD_Camera{
         return 0;
     }
 
+    Camera_Memory* Camera::Newest_Memory(){
+        // Find out which buffer the driver most recently finished writing.
+        int seq_Num;
+        char* current_Buffer;
+        char* last_Buffer;
+        m_Ret = is_GetActSeqBuf(m_hG, &seq_Num, &current_Buffer, &last_Buffer);
+        if (m_Ret != IS_SUCCESS) {
+            std::cout << "Fail. Get sequence buffer says: " << m_Ret << "\n";
+            return nullptr;
+        }
+
+        std::vector<Camera_Memory> &active_Ring = aoi_Set ? aoi_Ring : frame_Ring;
+        for (auto &memory : active_Ring){
+            if (memory.buffer == last_Buffer){
+                return &memory;
+            }
+        }
+        return nullptr;
+    }
+
+    Camera_Memory* Camera::Wait_For_New_Frame(){
+        // The frame event might have been set by a frame that has already
+        // been used (or been skipped over) so check the frame number of
+        // the newest buffer rather than trusting the event.
+        while(true){
+            Camera_Memory* newest_Memory = Newest_Memory();
+            if (newest_Memory != nullptr){
+                UEYEIMAGEINFO image_Info;
+                m_Ret = is_GetImageInfo(m_hG, newest_Memory->id, &image_Info, sizeof(image_Info));
+                if ((m_Ret == IS_SUCCESS) && (image_Info.u64FrameNumber != last_Frame_Number)){
+                    last_Frame_Number = image_Info.u64FrameNumber;
+                    last_Frame_Timestamp = image_Info.u64TimestampDevice;
+                    return newest_Memory;
+                }
+            }
+
+            if (Wait_For_Frame_Event() != IS_SUCCESS){
+                std::cout << "Timed out waiting for a frame" << "\n";
+                return nullptr;
+            }
+        }
+    }
+
+    int Camera::Wait_For_Frame_Event(){
+        // Give up if nothing turns up within a few frame periods (with a
+        // sensible minimum for when the frame rate is silly low)
+        int timeout = 1000;
+        if (current_Exposure.frame_Rate > 0){
+            timeout = std::max(100, (int)(3000 / current_Exposure.frame_Rate));
+        }
+        #ifdef _WIN32
+        if (WaitForSingleObject(frame_Event, timeout) == WAIT_OBJECT_0){
+            return IS_SUCCESS;
+        }
+        return IS_TIMED_OUT;
+        #else
+        return is_WaitEvent(m_hG, IS_SET_EVENT_FRAME, timeout);
+        #endif // _WIN32
+    }
+
+    int Camera::Start_Capture(){
+        if (continuous_Capture && !capture_Running){
+            m_Ret = is_CaptureVideo(m_hG, IS_DONT_WAIT);
+            std::cout << "Start continuous capture says: " << m_Ret << "\n";
+            capture_Running = (m_Ret == IS_SUCCESS);
+        }
+        return 0;
+    }
+
+    int Camera::Stop_Capture(){
+        if (capture_Running){
+            is_StopLiveVideo(m_hG, IS_FORCE_VIDEO_STOP);
+            capture_Running = false;
+        }
+        return 0;
+    }
+
+    const Frame_View& Camera::Get_Frame(){
+        return current_Frame;
+    }
+
     const std::vector<uint16_t>& Camera::Get_Picture(){
-        Take_Picture();
+        if (Take_Picture() != 0){
+            // Whatever was there last time.
+            return aoi_Set ? aoi_Image_Data : full_Image_Data;
+        }
 
         if(aoi_Set){
+            Copy_Memory(current_Frame, aoi_Image_Data);
             return aoi_Image_Data;
         }
         else{
+            Copy_Memory(current_Frame, full_Image_Data);
             return full_Image_Data;
         }
     }
 
-    int Camera::Copy_Memory(Camera_Memory &my_Buffer, std::vector<uint16_t> &my_Dest_Vector){
+    int Camera::Copy_Memory(const Frame_View &my_Frame, std::vector<uint16_t> &my_Dest_Vector){
         //std::cout << "Copy memory" << "\n";
-        if (m_nBitsPerPixel > 8){
-            uint16_t first_Byte;
-            uint16_t second_Byte;
-            uint16_t shift = 16 - m_nBitsPerPixel;
-            for(unsigned  int i=0; i < my_Dest_Vector.size() * 2; i+=2){
-                first_Byte = (uint8_t)my_Buffer.buffer[i];
-                second_Byte = (uint8_t)my_Buffer.buffer[i+1];
-
-                my_Dest_Vector[i/2] = ((first_Byte << 0) + (second_Byte << 8)) >> shift;
+        if (!my_Frame.Valid()){
+            return 1;
+        }
+        Count_Image_Copy();
+        if (my_Dest_Vector.size() != (unsigned int)my_Frame.Num_Pixels()){
+            my_Dest_Vector.resize(my_Frame.Num_Pixels());
+        }
+
+        // One line at a time since lines may be padded in the driver memory.
+        // The unpack kernels use SSE2/AVX2 where available.
+        uint16_t* dest = my_Dest_Vector.data();
+        for(int y=0; y < my_Frame.height; y++){
+            if (my_Frame.bits_Per_Pixel > 8){
+                Unpack_Mono16(my_Frame.Row(y), dest, my_Frame.width, my_Frame.Shift());
+            }
+            else{
+                Unpack_Mono8(my_Frame.Row(y), dest, my_Frame.width);
             }
+            dest += my_Frame.width;
         }
-        else{
-            for(unsigned int i=0; i < my_Dest_Vector.size(); i++){
-                my_Dest_Vector[i] = (uint8_t)my_Buffer.buffer[i];
+        return 0;
+    }
+
+    uint64_t Camera::Get_Image_Copies(){
+        return image_Copies.load(std::memory_order_relaxed);
+    }
+
+    int Camera::Calibrate_Pixel_Map(int n_Frames, double hot_Thresh, double stuck_Fraction){
+        // Has to be the whole sensor.
+        bool was_AOI = aoi_Set;
+        if (was_AOI){
+            Disable_AOI();
+        }
+
+        std::cout << "Calibrating pixel map from " << n_Frames << " frames, camera should be covered" << "\n";
+        Pixel_Map new_Map;
+        int n_Errors = 0;
+        int n_Taken = 0;
+        for(int i=0; i < n_Frames; i++){
+            if (Take_Picture() != 0){
+                // No frame this time, the map just gets one fewer.
+                continue;
             }
+            if (n_Taken == 0){
+                n_Errors += new_Map.Start_Calibration(Get_Frame());
+            }
+            n_Errors += new_Map.Add_Calibration_Frame(Get_Frame());
+            n_Taken++;
+        }
+        if ((n_Taken > 0) && (n_Errors == 0) && (new_Map.Finish_Calibration(hot_Thresh, stuck_Fraction) == 0)){
+            pixel_Map = new_Map;
+            if (!pixel_Map_File.empty()){
+                pixel_Map.Save(pixel_Map_File);
+            }
+        }
+        else{
+            std::cout << "Pixel map calibration failed, keeping the old one" << "\n";
+            n_Errors++;
+        }
+
+        if (was_AOI){
+            Enable_AOI();
+        }
+        return n_Errors;
+    }
+
+    const Pixel_Map& Camera::Get_Pixel_Map(){
+        return pixel_Map;
+    }
+
+    int Camera::Set_Pixel_Map(const Pixel_Map& new_Map){
+        pixel_Map = new_Map;
+        return 0;
+    }
+
+    int Camera::Alloc_Ring(std::vector<Camera_Memory> &my_Ring, int width, int height){
+        my_Ring.resize(n_Buffers);
+        for (auto &memory : my_Ring){
+            is_AllocImageMem(m_hG, width, height, m_nBitsPerPixel,
+                                &memory.buffer, &memory.id);
+            // The driver may pad the lines, ask how it actually laid it out.
+            int bits;
+            is_InquireImageMem(m_hG, memory.buffer, memory.id,
+                                &memory.width, &memory.height, &bits, &memory.pitch);
+        }
+        return 0;
+    }
+
+    int Camera::Free_Ring(std::vector<Camera_Memory> &my_Ring){
+        for (auto &memory : my_Ring){
+            is_FreeImageMem(m_hG, memory.buffer, memory.id);
+        }
+        my_Ring.clear();
+        return 0;
+    }
+
+    int Camera::Activate_Ring(std::vector<Camera_Memory> &my_Ring){
+        // Must not be called while capture is running (see Stop_Capture).
+        // Whatever was in the old sequence is about to be forgotten about.
+        Release_Frame();
+        current_Frame = Frame_View();
+
+        is_ClearSequence(m_hG);
+        for (auto &memory : my_Ring){
+            is_AddToSequence(m_hG, memory.buffer, memory.id);
+        }
+        return 0;
+    }
+
+    int Camera::Release_Frame(){
+        if (locked_Buffer != nullptr){
+            is_UnlockSeqBuf(m_hG, IS_IGNORE_PARAMETER, locked_Buffer);
+            locked_Buffer = nullptr;
         }
         return 0;
     }
 
     int Camera::Save_Picture(std::string filename, bool binary){
+        // The image vectors are only filled when needed, ie. now.
         if(aoi_Set == false){
+            Copy_Memory(current_Frame, full_Image_Data);
             if (binary){
                 return Dump_Binary(full_Image_Data, filename);
             }
@@ -245,6 +519,7 @@ namespace LD_Camera{
             }
         }
         else{
+            Copy_Memory(current_Frame, aoi_Image_Data);
             if (binary){
                 return Dump_Binary(aoi_Image_Data, filename);
             }
@@ -310,14 +585,32 @@ namespace LD_Camera{
         new_AOI.aoi_Size.s32Height = new_AOI.aoi_Size.s32Height - (new_AOI.aoi_Size.s32Height % aoi_Size_Increment.s32Height);
         new_AOI.aoi_Size.s32Width = new_AOI.aoi_Size.s32Width - (new_AOI.aoi_Size.s32Width % aoi_Size_Increment.s32Width);
 
+        bool size_Changed = (new_AOI.aoi_Size.s32Width != my_AOI.aoi_Size.s32Width) ||
+                            (new_AOI.aoi_Size.s32Height != my_AOI.aoi_Size.s32Height);
         my_AOI = new_AOI;
 
-        // Reallocate memory for this image buffer
-        // TODO: only do this if my_AOI.aoi_Size != new_AOI.aoi_Size
-        is_AllocImageMem(m_hG, my_AOI.aoi_Size.s32Width, my_AOI.aoi_Size.s32Height, m_nBitsPerPixel,
-                    &aoi_Memory.buffer, &aoi_Memory.id);
-        // and reallocate the vector container too.
-        aoi_Image_Data.resize(my_AOI.aoi_Size.s32Width * my_AOI.aoi_Size.s32Height, 0);
+        // Reallocate memory for this image buffer, but only if it needs to
+        // be a different size.
+        if (size_Changed){
+            if (aoi_Set){
+                // Can't free memories the driver is using, or the frame
+                // still locked in one of them.
+                Stop_Capture();
+                Release_Frame();
+                current_Frame = Frame_View();
+                Activate_Ring(frame_Ring);
+            }
+            Free_Ring(aoi_Ring);
+            Alloc_Ring(aoi_Ring, my_AOI.aoi_Size.s32Width, my_AOI.aoi_Size.s32Height);
+            if (aoi_Set){
+                // The sensor is still putting out the old size. Change_AOI
+                // sets the new one before activating the new ring and
+                // starting capture again.
+                Change_AOI(my_AOI);
+            }
+            // and reallocate the vector container too.
+            aoi_Image_Data.resize(my_AOI.aoi_Size.s32Width * my_AOI.aoi_Size.s32Height, 0);
+        }
         return 0;
     }
 
@@ -337,6 +630,9 @@ namespace LD_Camera{
         temp_New_AOI.s32X = new_AOI.aoi_Position.s32X;
         temp_New_AOI.s32Y = new_AOI.aoi_Position.s32Y;
 
+        // The image size can't change under a running capture.
+        Stop_Capture();
+
         // Set the AOI.
         m_Ret = is_AOI(m_hG, IS_AOI_IMAGE_SET_AOI, (void*)&temp_New_AOI, sizeof(temp_New_AOI));
         std::cout << "Set AOI says: " << m_Ret << "\n";
@@ -344,11 +640,14 @@ namespace LD_Camera{
         // Activate relevant image memory based on whether this was called by
         // Enable_AOI or Disable_AOI.
         if (aoi_Set){
-            is_SetImageMem(m_hG, aoi_Memory.buffer, aoi_Memory.id);
+            Activate_Ring(aoi_Ring);
         }
         else{
-            is_SetImageMem(m_hG, frame_Memory.buffer, frame_Memory.id);
+            Activate_Ring(frame_Ring);
         }
+
+        // Does nothing unless in continuous mode.
+        Start_Capture();
         return 0;
     }
 
@@ -0,0 +1,252 @@
+#include "LD_Display.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef HAVE_OPENCV
+LD_Display::LD_Display()
+    : middle_Slot(2), keys_Written(0), keys_Read(0), stopping(false)
+{
+    keys.fill(255);
+    frame_Period = std::chrono::steady_clock::duration::zero();
+}
+
+LD_Display::~LD_Display()
+{
+    Stop();
+}
+
+int LD_Display::Start(const Display_Options& new_Options){
+    if (display_Thread.joinable()){
+        return 0;
+    }
+    options = new_Options;
+    if (options.decimation < 1){
+        std::cout << "Display decimation " << options.decimation << " not supported, showing every pixel" << "\n";
+        options.decimation = 1;
+    }
+    // Made for the first frame, when the bits per pixel are known.
+    lut_Bits = 0;
+    if (options.max_Rate > 0){
+        frame_Period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / options.max_Rate));
+    }
+    else{
+        frame_Period = std::chrono::steady_clock::duration::zero();
+    }
+    next_Post = std::chrono::steady_clock::now();
+    stopping = false;
+    display_Thread = std::thread(&LD_Display::Display_Loop, this);
+    return 0;
+}
+
+int LD_Display::Stop(){
+    if (!display_Thread.joinable()){
+        return 0;
+    }
+    stopping = true;
+    display_Thread.join();
+    return 0;
+}
+
+int LD_Display::Post_Frame(const LD_Camera::Frame_View& my_Frame, const Display_Overlay& overlay){
+    if (!display_Thread.joinable() || !my_Frame.Valid()){
+        return 0;
+    }
+    // The display can't show more than frame_Period allows, so don't bother
+    // copying frames it would never draw.
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now < next_Post){
+        return 0;
+    }
+    next_Post = now + frame_Period;
+
+    Display_Slot& slot = slots[post_Slot];
+    int decimation = overlay.aoi_Set ? 1 : options.decimation;
+    int width = (my_Frame.width + decimation - 1) / decimation;
+    int height = (my_Frame.height + decimation - 1) / decimation;
+    int bytes_Per_Pixel = my_Frame.Bytes_Per_Pixel();
+    int row_Bytes = width * bytes_Per_Pixel;
+    // Only ever grows, so no allocating once the biggest frame's been seen.
+    slot.pixels.resize(std::max(slot.pixels.size(), (size_t)row_Bytes * height));
+    LD_Camera::Count_Image_Copy();
+    for(int y=0; y < height; y++){
+        const uint8_t* in = my_Frame.Row(y * decimation);
+        uint8_t* out = slot.pixels.data() + (y * row_Bytes);
+        if (decimation == 1){
+            std::memcpy(out, in, row_Bytes);
+        }
+        else if (bytes_Per_Pixel > 1){
+            const uint16_t* in_16 = (const uint16_t*)in;
+            uint16_t* out_16 = (uint16_t*)out;
+            for(int x=0; x < width; x++){
+                out_16[x] = in_16[x * decimation];
+            }
+        }
+        else{
+            for(int x=0; x < width; x++){
+                out[x] = in[x * decimation];
+            }
+        }
+    }
+    slot.frame = my_Frame;
+    slot.frame.data = slot.pixels.data();
+    slot.frame.width = width;
+    slot.frame.height = height;
+    slot.frame.stride = row_Bytes;
+    slot.decimation = decimation;
+    slot.overlay = overlay;
+
+    // Put it in the middle, and take whichever slot was there (either the
+    // one the display just gave back, or a frame it never got to) to fill
+    // next time.
+    post_Slot = middle_Slot.exchange(post_Slot | fresh_Frame, std::memory_order_acq_rel) & ~fresh_Frame;
+    return 0;
+}
+
+bool LD_Display::Next_Key(int& kb_Hit){
+    uint64_t n_Read = keys_Read.load(std::memory_order_relaxed);
+    if (n_Read == keys_Written.load(std::memory_order_acquire)){
+        return false;
+    }
+    kb_Hit = keys[n_Read % keys.size()];
+    keys_Read.store(n_Read + 1, std::memory_order_release);
+    return true;
+}
+
+void LD_Display::Display_Loop(){
+    while(!stopping){
+        std::chrono::steady_clock::time_point next_Draw = std::chrono::steady_clock::now() + frame_Period;
+
+        if (middle_Slot.load(std::memory_order_relaxed) & fresh_Frame){
+            draw_Slot = middle_Slot.exchange(draw_Slot, std::memory_order_acq_rel) & ~fresh_Frame;
+            Draw_Slot(slots[draw_Slot]);
+        }
+
+        // waitKey is what actually gets the window drawn (and its events
+        // handled), so it has to be called even without a new frame.
+        int kb_Hit = cv::waitKey(1);
+        // -1 or 255 (depending on the opencv version) means no key.
+        if ((kb_Hit != -1) && (kb_Hit != 255)){
+            uint64_t n_Written = keys_Written.load(std::memory_order_relaxed);
+            if (n_Written - keys_Read.load(std::memory_order_acquire) < keys.size()){
+                keys[n_Written % keys.size()] = kb_Hit;
+                keys_Written.store(n_Written + 1, std::memory_order_release);
+            }
+            else{
+                std::cout << "Key " << kb_Hit << " dropped, tracker isn't reading keys" << "\n";
+            }
+        }
+
+        std::this_thread::sleep_until(next_Draw);
+    }
+}
+
+int LD_Display::Draw_Slot(const Display_Slot& slot){
+    const Display_Overlay& overlay = slot.overlay;
+    int decimation = slot.decimation;
+
+    // Need an opencv mat to pass to cv::imshow
+    if (slot.frame.bits_Per_Pixel != lut_Bits){
+        Make_LUT(slot.frame.bits_Per_Pixel);
+    }
+    Make_Opencv_Mat(slot.frame);
+
+    switch (overlay.display_Mode){
+        // Note that this falls through all the way down. (hence the
+        // reverse order of the cases)
+        case 3:
+            if(overlay.aoi_Set == false){
+                Draw_AOI(overlay.aoi, decimation);
+            }
+            [[fallthrough]];
+        case 2:
+            Draw_Spot({(float)overlay.setpoint.x, (float)overlay.setpoint.y}, decimation, {0, 255, 0});
+            [[fallthrough]];
+        case 1:
+            if (overlay.spot_Found){
+                Draw_Spot(overlay.spot_Coords, decimation, {0,0,255});
+            }
+            [[fallthrough]];
+        case 0:
+            // Just display the image with nothing else.
+            break;
+    }
+
+    cv::imshow("hello", myMat);
+    return 0;
+}
+
+int LD_Display::Make_LUT(int bits_Per_Pixel){
+    int n_Values = 1 << bits_Per_Pixel;
+    int black = std::min(std::max(options.black_Level, 0), n_Values - 1);
+    int white = (options.white_Level > 0) ? options.white_Level : (n_Values - 1);
+    if (white <= black){
+        std::cout << "Display white level " << white << " not above black level "
+                  << black << ", using the whole range" << "\n";
+        black = 0;
+        white = n_Values - 1;
+    }
+    double inverse_Gamma = (options.gamma > 0) ? (1 / options.gamma) : 1;
+
+    lut.resize(n_Values);
+    for(int value=0; value < n_Values; value++){
+        double level = (double)(value - black) / (white - black);
+        level = std::min(std::max(level, 0.0), 1.0);
+        lut[value] = std::lround(255 * std::pow(level, inverse_Gamma));
+    }
+    lut_Bits = bits_Per_Pixel;
+    return 0;
+}
+
+int LD_Display::Make_Opencv_Mat(const LD_Camera::Frame_View& my_Frame){
+    // Nothing's allocated unless the frame changes size.
+    myMat.create(my_Frame.height, my_Frame.width, CV_8UC3);
+    const uint8_t* levels = lut.data();
+    int shift = my_Frame.Shift();
+    for(int y=0; y < my_Frame.height; y++){
+        uint8_t* out = myMat.ptr<uint8_t>(y);
+        if (my_Frame.bits_Per_Pixel > 8){
+            const uint16_t* in = (const uint16_t*)my_Frame.Row(y);
+            for(int x=0; x < my_Frame.width; x++){
+                uint8_t level = levels[in[x] >> shift];
+                out[0] = level;
+                out[1] = level;
+                out[2] = level;
+                out += 3;
+            }
+        }
+        else{
+            const uint8_t* in = my_Frame.Row(y);
+            for(int x=0; x < my_Frame.width; x++){
+                uint8_t level = levels[in[x]];
+                out[0] = level;
+                out[1] = level;
+                out[2] = level;
+                out += 3;
+            }
+        }
+    }
+    return 0;
+}
+
+int LD_Display::Draw_Spot(LD_Camera::Subpixel_Values spot_Position, int decimation, cv::Scalar colour){
+    // Draw a spot on the currently stored mat containing the camera image.
+    cv::Point spot_Centre((int)(spot_Position.x / decimation), (int)(spot_Position.y / decimation));
+    cv::circle(myMat, spot_Centre, 15, colour, 2, 8, 0);
+    return 0;
+}
+
+int LD_Display::Draw_AOI(LD_Camera::AOI my_AOI, int decimation){
+    // Draw a rectangle corresponding to the AOI position in the full
+    // frame.
+    cv::Point top_Left(my_AOI.aoi_Position.s32X / decimation,
+                       my_AOI.aoi_Position.s32Y / decimation);
+    cv::Point bottom_Right ((my_AOI.aoi_Position.s32X + my_AOI.aoi_Size.s32Width) / decimation,
+                            (my_AOI.aoi_Position.s32Y + my_AOI.aoi_Size.s32Height) / decimation);
+    cv::rectangle(myMat, top_Left, bottom_Right, {255,0,0} , 2, 8, 0);
+    return 0;
+}
+#endif // HAVE_OPENCV
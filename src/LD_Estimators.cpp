@@ -0,0 +1,111 @@
+#include "LD_Estimators.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace LD_QuarcTracker{
+    namespace{
+        // First of the biggest bins. Written out rather than max_element so
+        // it compiles to conditional moves, the noise on the way up to the
+        // peak has the branch in max_element mispredicting a lot.
+        int Peak_Bin(const std::vector<uint64_t>& distribution){
+            int peak = 0;
+            uint64_t peak_Value = distribution[0];
+            for(unsigned int i=1; i < distribution.size(); i++){
+                bool bigger = distribution[i] > peak_Value;
+                peak_Value = bigger ? distribution[i] : peak_Value;
+                peak = bigger ? i : peak;
+            }
+            return peak;
+        }
+
+        // Where the vertex of the parabola through (-1, left), (0, middle)
+        // and (1, right) is, relative to the middle one. middle is the
+        // biggest so it's somewhere in [-0.5, 0.5].
+        double Vertex_Offset(double left, double middle, double right){
+            double curvature = left - 2 * middle + right;
+            if (curvature >= 0){
+                // Flat (or not a peak at all)
+                return 0;
+            }
+            return 0.5 * (left - right) / curvature;
+        }
+    } // namespace
+
+    float Thresholded_Centroid(const std::vector<uint64_t>& distribution, double thresh_Fraction){
+        if (distribution.empty()){
+            return 0;
+        }
+        uint64_t distribution_Max = distribution[Peak_Bin(distribution)];
+        uint64_t gaussian_Thresh = distribution_Max * thresh_Fraction;
+
+        int i = 0;
+        uint64_t running_Total = 0;
+        uint64_t running_Weights = 0;
+        for(auto pixel : distribution){
+            if (pixel > gaussian_Thresh){
+                // Only consider significantly big enough values to make sure
+                // low level noise is not skewing the result
+                running_Total += (i * pixel);
+                running_Weights += pixel;
+            }
+            i++;
+        }
+        if (running_Weights == 0){
+            return Peak_Bin(distribution);
+        }
+        // The centre of the distribution to subpixel accuracy.
+        return ((float)running_Total) / ((float)running_Weights);
+    }
+
+    float Windowed_Centroid(const std::vector<uint64_t>& distribution, int half_Width){
+        if (distribution.empty()){
+            return 0;
+        }
+        int peak = Peak_Bin(distribution);
+        int first = std::max(peak - half_Width, 0);
+        int last = std::min(peak + half_Width, (int)distribution.size() - 1);
+
+        uint64_t running_Total = 0;
+        uint64_t running_Weights = 0;
+        for(int i=first; i <= last; i++){
+            running_Total += (i - first) * distribution[i];
+            running_Weights += distribution[i];
+        }
+        if (running_Weights == 0){
+            return peak;
+        }
+        // Relative to the start of the window so the totals stay small.
+        return first + ((double)running_Total) / ((double)running_Weights);
+    }
+
+    float Parabolic_Peak(const std::vector<uint64_t>& distribution){
+        if (distribution.empty()){
+            return 0;
+        }
+        int peak = Peak_Bin(distribution);
+        if ((peak == 0) || (peak == (int)distribution.size() - 1)){
+            return peak;
+        }
+        return peak + Vertex_Offset(distribution[peak - 1], distribution[peak], distribution[peak + 1]);
+    }
+
+    float Gaussian_Peak(const std::vector<uint64_t>& distribution){
+        if (distribution.empty()){
+            return 0;
+        }
+        int peak = Peak_Bin(distribution);
+        if ((peak == 0) || (peak == (int)distribution.size() - 1)){
+            return peak;
+        }
+        uint64_t left = distribution[peak - 1];
+        uint64_t right = distribution[peak + 1];
+        if ((left == 0) || (right == 0)){
+            // No log of nothing, the spot's too narrow to say much anyway.
+            return Parabolic_Peak(distribution);
+        }
+        return peak + Vertex_Offset(std::log((double)left), std::log((double)distribution[peak]),
+                                    std::log((double)right));
+    }
+
+} // namespace LD_QuarcTracker
@@ -0,0 +1,73 @@
+#include "LD_Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace LD_QuarcTracker{
+
+    int Reset_Histogram(Pixel_Histogram& histogram, int bits_Per_Pixel){
+        histogram.banks.resize(histogram_Banks * histogram_Bank_Stride);
+        histogram.counts.resize(histogram_Bins);
+        histogram.n_Pixels = 0;
+        histogram.bin_Shift = std::max(bits_Per_Pixel - 10, 0);
+        histogram.n_Bins = std::min(1 << bits_Per_Pixel, histogram_Bins);
+        for(int bank=0; bank < histogram_Banks; bank++){
+            std::fill_n(histogram.banks.begin() + (bank * histogram_Bank_Stride), histogram.n_Bins, 0);
+        }
+        std::fill_n(histogram.counts.begin(), histogram.n_Bins, 0);
+        return 0;
+    }
+
+    void Add_Pixel(Pixel_Histogram& histogram, uint16_t pixel){
+        histogram.banks[pixel >> histogram.bin_Shift]++;
+    }
+
+    int Merge_Histogram(Pixel_Histogram& histogram, const Pixel_Histogram& other){
+        if ((histogram.bin_Shift != other.bin_Shift) || (histogram.n_Bins != other.n_Bins)){
+            std::cout << "Can't merge histograms of different pixel depths" << "\n";
+            return 1;
+        }
+        for(int bank=0; bank < histogram_Banks; bank++){
+            uint32_t* bank_Counts = histogram.banks.data() + (bank * histogram_Bank_Stride);
+            const uint32_t* other_Counts = other.banks.data() + (bank * histogram_Bank_Stride);
+            for(int bin=0; bin < histogram.n_Bins; bin++){
+                bank_Counts[bin] += other_Counts[bin];
+            }
+        }
+        return 0;
+    }
+
+    int Finish_Histogram(Pixel_Histogram& histogram){
+        // A bank at a time, so the adds are along the memory.
+        uint32_t* counts = histogram.counts.data();
+        std::copy_n(histogram.banks.begin(), histogram.n_Bins, counts);
+        for(int bank=1; bank < histogram_Banks; bank++){
+            const uint32_t* bank_Counts = histogram.banks.data() + (bank * histogram_Bank_Stride);
+            for(int bin=0; bin < histogram.n_Bins; bin++){
+                counts[bin] += bank_Counts[bin];
+            }
+        }
+        histogram.n_Pixels = 0;
+        for(int bin=0; bin < histogram.n_Bins; bin++){
+            histogram.n_Pixels += counts[bin];
+        }
+        return 0;
+    }
+
+    uint16_t Percentile(const Pixel_Histogram& histogram, double fraction){
+        if (histogram.n_Pixels == 0){
+            return 0;
+        }
+        uint64_t wanted = std::max<uint64_t>(1, std::ceil(fraction * histogram.n_Pixels));
+        uint64_t running_Total = 0;
+        for(int bin=0; bin < histogram.n_Bins; bin++){
+            running_Total += histogram.counts[bin];
+            if (running_Total >= wanted){
+                return bin << histogram.bin_Shift;
+            }
+        }
+        return (histogram.n_Bins - 1) << histogram.bin_Shift;
+    }
+
+} // namespace LD_QuarcTracker
@@ -0,0 +1,143 @@
+#include "LD_Integral.h"
+#include "LD_RowKernels.h"
+
+#include <algorithm>
+
+namespace LD_QuarcTracker{
+
+    Integral_Image::Integral_Image()
+    {
+        //ctor
+    }
+
+    Integral_Image::~Integral_Image()
+    {
+        //dtor
+    }
+
+    int Integral_Image::Build(const LD_Camera::Frame_View& my_Frame, uint16_t floor,
+                              const Pixel_Corrections& corrections){
+        if (!my_Frame.Valid()){
+            width = 0;
+            height = 0;
+            return 1;
+        }
+        width = my_Frame.width;
+        height = my_Frame.height;
+        frame = my_Frame;
+        frame_Floor = floor;
+        frame_Corrections = corrections;
+        int table_Width = width + 1;
+        int table_Size = table_Width * (height + 1);
+        // Only the first row and column need to be 0, everything else gets
+        // written, so don't clear it all again if the size is the same.
+        if (sums_I.size() != (unsigned int)table_Size){
+            sums_I.assign(table_Size, 0);
+        }
+        line.resize(width);
+
+        for(int row=0; row < height; row++){
+            Corrected_Row(my_Frame, row, Corrections_For_Row(corrections, my_Frame, row), line.data());
+            int above = (row * table_Width) + 1;
+            int below = above + table_Width;
+            Integral_Row(line.data(), width, floor, sums_I.data() + above, sums_I.data() + below);
+        }
+        return 0;
+    }
+
+    bool Integral_Image::Valid() const{
+        return (width > 0) && (height > 0);
+    }
+
+    int Integral_Image::Width() const{
+        return width;
+    }
+
+    int Integral_Image::Height() const{
+        return height;
+    }
+
+    void Integral_Image::Clip(int x, int y, int window_Width, int window_Height,
+                              int& left, int& top, int& right, int& bottom) const{
+        left = std::min(std::max(x, 0), width);
+        top = std::min(std::max(y, 0), height);
+        right = std::min(std::max(x + window_Width, left), width);
+        bottom = std::min(std::max(y + window_Height, top), height);
+    }
+
+    Window_Moments Integral_Image::Window(int x, int y, int window_Width, int window_Height){
+        Window_Moments moments = {0, -1, -1};
+        if (!Valid()){
+            return moments;
+        }
+        int left, top, right, bottom;
+        Clip(x, y, window_Width, window_Height, left, top, right, bottom);
+        LD_Camera::Frame_View window = frame.Sub_View(left, top, right - left, bottom - top);
+        if (!window.Valid()){
+            return moments;
+        }
+        // The same pixels Build added up, corrected the same way.
+        uint64_t total_X = 0;
+        uint64_t total_Y = 0;
+        for(int row=0; row < window.height; row++){
+            Corrected_Row(window, row, Corrections_For_Row(frame_Corrections, window, row), line.data());
+            uint32_t row_Total = 0;
+            uint64_t row_X = 0;
+            for(int col=0; col < window.width; col++){
+                uint32_t pixel = (line[col] > frame_Floor) ? (line[col] - frame_Floor) : 0;
+                row_Total += pixel;
+                row_X += (uint64_t)pixel * col;
+            }
+            moments.total += row_Total;
+            total_X += row_X + (uint64_t)row_Total * left;
+            total_Y += (uint64_t)row_Total * (top + row);
+        }
+        if (moments.total > 0){
+            moments.x = (double)total_X / moments.total;
+            moments.y = (double)total_Y / moments.total;
+        }
+        return moments;
+    }
+
+    uint64_t Integral_Image::Window_Total(int x, int y, int window_Width, int window_Height) const{
+        if (!Valid()){
+            return 0;
+        }
+        int left, top, right, bottom;
+        Clip(x, y, window_Width, window_Height, left, top, right, bottom);
+        int table_Width = width + 1;
+        return (uint32_t)(sums_I[bottom * table_Width + right] - sums_I[top * table_Width + right] -
+                          sums_I[bottom * table_Width + left] + sums_I[top * table_Width + left]);
+    }
+
+    uint64_t Integral_Image::Brightest_Window(int window_Width, int window_Height, int step,
+                                              int& x, int& y) const{
+        uint64_t brightest_Total = 0;
+        x = 0;
+        y = 0;
+        step = std::max(step, 1);
+        // Windows bigger than the frame are just the frame.
+        int last_X = std::max(width - window_Width, 0);
+        int last_Y = std::max(height - window_Height, 0);
+        // The last step is cut short so the right and bottom edges get
+        // looked at too.
+        for(int top=0; ; top = std::min(top + step, last_Y)){
+            for(int left=0; ; left = std::min(left + step, last_X)){
+                uint64_t total = Window_Total(left, top, window_Width, window_Height);
+                if (total > brightest_Total){
+                    brightest_Total = total;
+                    x = left;
+                    y = top;
+                }
+                if (left == last_X){
+                    break;
+                }
+            }
+            if (top == last_Y){
+                break;
+            }
+        }
+        return brightest_Total;
+    }
+
+} // namespace LD_QuarcTracker
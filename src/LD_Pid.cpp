@@ -1,5 +1,5 @@
 #include "LD_Pid.h"
-#include <chrono>
+#include <algorithm>
 #include <iostream>
 
 PIDLoop::PIDLoop() {}
@@ -11,70 +11,65 @@ PIDLoop::PIDLoop(PIDParams my_Options) {
 PIDLoop::~PIDLoop() {}
 
 int PIDLoop::InitPID(PIDParams my_Options) {
-	k_P = my_Options.P;
-	k_I = my_Options.I;
-	k_D = my_Options.D;
-	std::cout << "Init PID with P:" << k_P << ", I:" << k_I << ", D:" << k_D << std::endl;
-	error_Last = 0;
-	integral = 0;
-	derivative = 0;
-	first_Loop = true;
-	max_Output = my_Options.max_Output;
-	min_Output = my_Options.min_Output;
-	constant_PID_Time = my_Options.constant_Time;
-	Timer1 = std::chrono::steady_clock::now();
-	Timer2 = std::chrono::steady_clock::now();
-	time_Interval = 40; // Default value if constant_PID_Time is true. Set to something sensible!
-	return 0;
+    ChangePID(my_Options);
+    std::cout << "Init PID with P:" << k_P << ", I:" << k_I << ", D:" << k_D << std::endl;
+    return ResetPID(0);
 }
 
-float PIDLoop::UpdatePID(float error){
-    // This time_Interval thing is horrible! Full of dodgy cludges at the moment! :/
-    if (!constant_PID_Time){
-        Timer2 = Timer1;
-        Timer1 = std::chrono::steady_clock::now();
-        time_Interval = std::chrono::duration_cast<std::chrono::milliseconds>(Timer1 - Timer2).count() / 10;
+float PIDLoop::UpdatePID(float error, float measurement, double time){
+    double time_Interval = 0;
+    if (!first_Loop){
+        time_Interval = time - time_Last;
+        if (time_Interval < 0){
+            // Clock went backwards (or changed), nothing sensible to do.
+            time_Interval = 0;
+        }
     }
 
-    error /= 1000;
-
     // P part.
-	proportional = k_P * error;
-
-
-    if (!first_Loop) {
-    // I and D terms not valid in first loop. Only do P for first step.
-        // I part. Clip to max range of mirror (just in case)
-        integral = integral + (k_I * (error*time_Interval/2));
-        if (integral > (max_Output / 2)) {
-            integral = max_Output / 2;
-        }
-        else if (integral < (min_Output / 2 )) {
-            integral = min_Output / 2;
-        }
-
-        // D part.
-        derivative = k_D * ((error - error_Last) / (time_Interval * 1000));
-	}
-	else {
-        first_Loop = false;
-	}
-
-    float output_PID = (proportional) + (integral) + (derivative);
+    proportional = k_P * error;
+
+    // D part, on the measurement. Needs a previous measurement and some time
+    // between them.
+    if (!first_Loop && (time_Interval > 0)){
+        double raw_Rate = (measurement - measurement_Last) / time_Interval;
+        // First order low pass, the same whatever the frame rate.
+        double alpha = time_Interval / (d_Filter_Time + time_Interval);
+        measurement_Rate += alpha * (raw_Rate - measurement_Rate);
+    }
+    derivative = k_D * measurement_Rate;
+
+    // I part. The integral can only grow as far as it takes the output to
+    // the limit, otherwise it winds up past the mirror's range and takes
+    // ages to come back. (It can always move back towards the range.)
+    double integral_Step = k_I * error * time_Interval;
+    double output_PID = proportional + integral + integral_Step + derivative;
+    if ((output_PID > max_Output) && (integral_Step > 0)){
+        integral = std::max(integral, max_Output - proportional - derivative);
+    }
+    else if ((output_PID < min_Output) && (integral_Step < 0)){
+        integral = std::min(integral, min_Output - proportional - derivative);
+    }
+    else{
+        integral += integral_Step;
+    }
+    output_PID = proportional + integral + derivative;
 
-	// Clip entire PID output to max range of mirror
-	if (output_PID > max_Output) {
-		output_PID = max_Output;
-	}
-	else if (output_PID < min_Output) {
-		output_PID = min_Output;
-	}
+    // Clip entire PID output to max range of mirror
+    if (output_PID > max_Output) {
+        output_PID = max_Output;
+    }
+    else if (output_PID < min_Output) {
+        output_PID = min_Output;
+    }
 
-	// We need this to calculate D term next time.
-	error_Last = error;
+    // We need these for the next time interval and D term.
+    measurement_Last = measurement;
+    time_Last = time;
+    first_Loop = false;
 
-	//std::cout << "P,I,D: " << (proportional) << ", " << (integral) << ", " << (derivative) << "\n";
-	return output_PID;
+    //std::cout << "P,I,D: " << (proportional) << ", " << (integral) << ", " << (derivative) << "\n";
+    return output_PID;
 }
 
 int PIDLoop::ChangePID(float myK_p, float myK_i, float myK_d){
@@ -85,9 +80,25 @@ int PIDLoop::ChangePID(float myK_p, float myK_i, float myK_d){
     return 0;
 }
 
-int PIDLoop::ResetPID(){
-	error_Last = 0;
-	integral = 0;
-	first_Loop = true;
+int PIDLoop::ChangePID(PIDParams my_Options){
+    ChangePID(my_Options.P, my_Options.I, my_Options.D);
+    d_Filter_Time = (my_Options.D_Filter_Time > 0) ? my_Options.D_Filter_Time : 0;
+    max_Output = my_Options.max_Output;
+    min_Output = my_Options.min_Output;
+    // The old measurement is in different co-ordinates.
+    measurement_Rate = 0;
+    first_Loop = true;
+    return 0;
+}
+
+int PIDLoop::ResetPID(float output){
+    // All of it in the integral, so it stays there until there's an error.
+    proportional = 0;
+    integral = output;
+    derivative = 0;
+    measurement_Rate = 0;
+    measurement_Last = 0;
+    time_Last = 0;
+    first_Loop = true;
     return 0;
 }
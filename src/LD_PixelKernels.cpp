@@ -0,0 +1,135 @@
+#include "LD_PixelKernels.h"
+
+#if LD_SIMD_X86
+#include <immintrin.h>
+#endif // LD_SIMD_X86
+
+namespace LD_Camera{
+    namespace{
+        // Plain versions, these are what the SIMD versions must match bit
+        // for bit. Bytes are assembled by hand so this works whatever the
+        // endianness of the machine.
+        void Unpack_Mono16_Scalar(const uint8_t* source, uint16_t* dest, int n_Pixels, int shift){
+            for(int i=0; i < n_Pixels; i++){
+                uint16_t first_Byte = source[2*i];
+                uint16_t second_Byte = source[2*i + 1];
+                dest[i] = ((first_Byte << 0) + (second_Byte << 8)) >> shift;
+            }
+        }
+
+        void Unpack_Mono8_Scalar(const uint8_t* source, uint16_t* dest, int n_Pixels){
+            for(int i=0; i < n_Pixels; i++){
+                dest[i] = source[i];
+            }
+        }
+
+        #if LD_SIMD_X86
+        // x86 is little endian so the raw MONO16 data can be loaded straight
+        // into 16 bit lanes.
+        LD_TARGET_SSE2
+        void Unpack_Mono16_SSE2(const uint8_t* source, uint16_t* dest, int n_Pixels, int shift){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            int i = 0;
+            for(; i + 8 <= n_Pixels; i += 8){
+                __m128i raw = _mm_loadu_si128((const __m128i*)(source + 2*i));
+                _mm_storeu_si128((__m128i*)(dest + i), _mm_srl_epi16(raw, count));
+            }
+            Unpack_Mono16_Scalar(source + 2*i, dest + i, n_Pixels - i, shift);
+        }
+
+        LD_TARGET_SSE2
+        void Unpack_Mono8_SSE2(const uint8_t* source, uint16_t* dest, int n_Pixels){
+            const __m128i zero = _mm_setzero_si128();
+            int i = 0;
+            for(; i + 16 <= n_Pixels; i += 16){
+                __m128i raw = _mm_loadu_si128((const __m128i*)(source + i));
+                _mm_storeu_si128((__m128i*)(dest + i), _mm_unpacklo_epi8(raw, zero));
+                _mm_storeu_si128((__m128i*)(dest + i + 8), _mm_unpackhi_epi8(raw, zero));
+            }
+            Unpack_Mono8_Scalar(source + i, dest + i, n_Pixels - i);
+        }
+
+        // Number of pixels to do one at a time before dest is 32 byte
+        // aligned. 256 bit stores straddling cache lines are slow enough to
+        // lose to SSE2 otherwise.
+        int Pixels_To_Align(const uint16_t* dest, int n_Pixels){
+            int head = ((32 - ((uintptr_t)dest & 31)) & 31) / sizeof(uint16_t);
+            return (head < n_Pixels) ? head : n_Pixels;
+        }
+
+        // No aligning here, unlike MONO8: the source is twice the size of
+        // the destination so one side is always unaligned anyway, and the
+        // scalar head cost more than the split stores it saved. The SSE2
+        // version mops up the tail. The compiler turns that call into a
+        // jump without clearing the top halves of the registers first, which
+        // slows down all the SSE code after it, so that's done by hand.
+        LD_TARGET_AVX2
+        void Unpack_Mono16_AVX2(const uint8_t* source, uint16_t* dest, int n_Pixels, int shift){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            int i = 0;
+            for(; i + 16 <= n_Pixels; i += 16){
+                __m256i raw = _mm256_loadu_si256((const __m256i*)(source + 2*i));
+                _mm256_storeu_si256((__m256i*)(dest + i), _mm256_srl_epi16(raw, count));
+            }
+            _mm256_zeroupper();
+            Unpack_Mono16_SSE2(source + 2*i, dest + i, n_Pixels - i, shift);
+        }
+
+        LD_TARGET_AVX2
+        void Unpack_Mono8_AVX2(const uint8_t* source, uint16_t* dest, int n_Pixels){
+            int i = Pixels_To_Align(dest, n_Pixels);
+            Unpack_Mono8_Scalar(source, dest, i);
+            for(; i + 32 <= n_Pixels; i += 32){
+                __m128i raw_A = _mm_loadu_si128((const __m128i*)(source + i));
+                __m128i raw_B = _mm_loadu_si128((const __m128i*)(source + i + 16));
+                _mm256_store_si256((__m256i*)(dest + i), _mm256_cvtepu8_epi16(raw_A));
+                _mm256_store_si256((__m256i*)(dest + i + 16), _mm256_cvtepu8_epi16(raw_B));
+            }
+            Unpack_Mono8_Scalar(source + i, dest + i, n_Pixels - i);
+        }
+        #endif // LD_SIMD_X86
+    } // namespace
+
+    void Unpack_Mono16(const uint8_t* source, uint16_t* dest, int n_Pixels, int shift){
+        Unpack_Mono16(source, dest, n_Pixels, shift, LD_Simd::Get_Simd_Level());
+    }
+
+    void Unpack_Mono8(const uint8_t* source, uint16_t* dest, int n_Pixels){
+        Unpack_Mono8(source, dest, n_Pixels, LD_Simd::Get_Simd_Level());
+    }
+
+    void Unpack_Mono16(const uint8_t* source, uint16_t* dest, int n_Pixels, int shift,
+                       LD_Simd::Simd_Level level){
+        #if LD_SIMD_X86
+        switch (level){
+            case LD_Simd::SIMD_AVX2:
+                return Unpack_Mono16_AVX2(source, dest, n_Pixels, shift);
+            case LD_Simd::SIMD_SSE2:
+                return Unpack_Mono16_SSE2(source, dest, n_Pixels, shift);
+            case LD_Simd::SIMD_NONE:
+                break;
+        }
+        #else
+        (void)level;
+        #endif // LD_SIMD_X86
+        Unpack_Mono16_Scalar(source, dest, n_Pixels, shift);
+    }
+
+    void Unpack_Mono8(const uint8_t* source, uint16_t* dest, int n_Pixels,
+                      LD_Simd::Simd_Level level){
+        #if LD_SIMD_X86
+        switch (level){
+            case LD_Simd::SIMD_AVX2:
+                return Unpack_Mono8_AVX2(source, dest, n_Pixels);
+            case LD_Simd::SIMD_SSE2:
+                return Unpack_Mono8_SSE2(source, dest, n_Pixels);
+            case LD_Simd::SIMD_NONE:
+                break;
+        }
+        #else
+        (void)level;
+        #endif // LD_SIMD_X86
+        Unpack_Mono8_Scalar(source, dest, n_Pixels);
+    }
+
+} // namespace LD_Camera
@@ -0,0 +1,262 @@
+#include "LD_PixelMap.h"
+#include "LD_PixelKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace LD_Camera{
+    namespace{
+        // Start of every pixel map file, and its layout version.
+        const char file_Magic[4] = {'L', 'D', 'P', 'M'};
+        const int32_t file_Version = 1;
+
+        struct File_Header{
+            char magic[4];
+            int32_t version;
+            int32_t width;
+            int32_t height;
+            int32_t bits_Per_Pixel;
+            int32_t n_Bad_Pixels;
+            int32_t n_Column_Offsets;
+        };
+
+        template <typename T>
+        void Write_Vector(std::ofstream& file_Out, const std::vector<T>& values){
+            file_Out.write((const char*)values.data(), values.size() * sizeof(T));
+        }
+
+        template <typename T>
+        void Read_Vector(std::ifstream& file_In, std::vector<T>& values, int n){
+            values.resize(n);
+            file_In.read((char*)values.data(), values.size() * sizeof(T));
+        }
+    } // namespace
+
+    Pixel_Map::Pixel_Map()
+    {
+        //ctor
+    }
+
+    Pixel_Map::~Pixel_Map()
+    {
+        //dtor
+    }
+
+    int Pixel_Map::Start_Calibration(const Frame_View& my_Frame){
+        if (!my_Frame.Valid()){
+            return 1;
+        }
+        if ((my_Frame.offset_X != 0) || (my_Frame.offset_Y != 0)){
+            std::cout << "Pixel map calibration needs the full frame, not an AOI" << "\n";
+            return 1;
+        }
+        width = my_Frame.width;
+        height = my_Frame.height;
+        bits_Per_Pixel = my_Frame.bits_Per_Pixel;
+        sums.assign(width * height, 0);
+        sum_Squares.assign(width * height, 0);
+        n_Calibration_Frames = 0;
+        return 0;
+    }
+
+    int Pixel_Map::Add_Calibration_Frame(const Frame_View& my_Frame){
+        if (!my_Frame.Valid() || (my_Frame.width != width) || (my_Frame.height != height) ||
+            (my_Frame.bits_Per_Pixel != bits_Per_Pixel) || sums.empty()){
+            std::cout << "Calibration frame doesn't match the first one" << "\n";
+            return 1;
+        }
+        std::vector<uint16_t> line(width);
+        for(int row=0; row < height; row++){
+            if (bits_Per_Pixel > 8){
+                Unpack_Mono16(my_Frame.Row(row), line.data(), width, my_Frame.Shift());
+            }
+            else{
+                Unpack_Mono8(my_Frame.Row(row), line.data(), width);
+            }
+            uint32_t* row_Sums = sums.data() + (row * width);
+            uint64_t* row_Squares = sum_Squares.data() + (row * width);
+            for(int col=0; col < width; col++){
+                row_Sums[col] += line[col];
+                row_Squares[col] += (uint32_t)line[col] * line[col];
+            }
+        }
+        n_Calibration_Frames++;
+        return 0;
+    }
+
+    int Pixel_Map::Finish_Calibration(double hot_Thresh, double stuck_Fraction){
+        if (n_Calibration_Frames < 1){
+            std::cout << "No calibration frames to make a pixel map from" << "\n";
+            return 1;
+        }
+        double n = n_Calibration_Frames;
+        std::vector<float> means(width * height);
+        std::vector<float> variances(width * height);
+        for(unsigned int i=0; i < means.size(); i++){
+            means[i] = sums[i] / n;
+            variances[i] = std::max(sum_Squares[i] / n - (double)means[i] * means[i], 0.0);
+        }
+
+        // The median of each column, so the hot pixels don't pull it up.
+        std::vector<float> column_Levels(width);
+        std::vector<float> column(height);
+        for(int col=0; col < width; col++){
+            for(int row=0; row < height; row++){
+                column[row] = means[row * width + col];
+            }
+            std::nth_element(column.begin(), column.begin() + (height / 2), column.end());
+            column_Levels[col] = column[height / 2];
+        }
+        float darkest = *std::min_element(column_Levels.begin(), column_Levels.end());
+        column_Offsets.resize(width);
+        for(int col=0; col < width; col++){
+            column_Offsets[col] = std::lround(column_Levels[col] - darkest);
+        }
+        if (*std::max_element(column_Offsets.begin(), column_Offsets.end()) == 0){
+            column_Offsets.clear();
+        }
+
+        // Stuck pixels can only be told apart with more than one frame.
+        std::vector<float> sorted_Variances = variances;
+        std::nth_element(sorted_Variances.begin(), sorted_Variances.begin() + (sorted_Variances.size() / 2),
+                         sorted_Variances.end());
+        float typical_Variance = sorted_Variances[sorted_Variances.size() / 2];
+        bool find_Stuck = (n_Calibration_Frames > 1) && (typical_Variance > 0);
+        float stuck_Variance = stuck_Fraction * stuck_Fraction * typical_Variance;
+
+        row_Start.assign(height + 1, 0);
+        bad_Cols.clear();
+        int n_Hot = 0;
+        int n_Stuck = 0;
+        for(int row=0; row < height; row++){
+            row_Start[row] = bad_Cols.size();
+            for(int col=0; col < width; col++){
+                int i = row * width + col;
+                bool hot = (means[i] - column_Levels[col]) > hot_Thresh;
+                bool stuck = find_Stuck && (variances[i] < stuck_Variance);
+                if (hot || stuck){
+                    bad_Cols.push_back(col);
+                    n_Hot += hot;
+                    n_Stuck += (stuck && !hot);
+                }
+            }
+        }
+        row_Start[height] = bad_Cols.size();
+
+        // Done with the totals.
+        std::vector<uint32_t>().swap(sums);
+        std::vector<uint64_t>().swap(sum_Squares);
+
+        int max_Offset = column_Offsets.empty() ? 0 :
+                         *std::max_element(column_Offsets.begin(), column_Offsets.end());
+        std::cout << "Pixel map from " << n_Calibration_Frames << " frames: " << n_Hot << " hot, "
+                  << n_Stuck << " stuck, column offsets up to " << max_Offset << "\n";
+        return 0;
+    }
+
+    bool Pixel_Map::Empty() const{
+        return bad_Cols.empty() && column_Offsets.empty();
+    }
+
+    int Pixel_Map::Num_Bad_Pixels() const{
+        return bad_Cols.size();
+    }
+
+    Bad_Columns Pixel_Map::Bad_In_Row(const Frame_View& my_Frame, int row) const{
+        Bad_Columns none = {nullptr, nullptr, 0};
+        int sensor_Y = my_Frame.offset_Y + row;
+        if (bad_Cols.empty() || (sensor_Y < 0) || (sensor_Y >= height)){
+            return none;
+        }
+        const uint16_t* row_First = bad_Cols.data() + row_Start[sensor_Y];
+        const uint16_t* row_Last = bad_Cols.data() + row_Start[sensor_Y + 1];
+        if (row_First == row_Last){
+            return none;
+        }
+        // Just the part of the row inside the frame.
+        Bad_Columns bad;
+        bad.first = std::lower_bound(row_First, row_Last, my_Frame.offset_X);
+        bad.last = std::lower_bound(bad.first, row_Last, my_Frame.offset_X + my_Frame.width);
+        bad.offset = my_Frame.offset_X;
+        return bad;
+    }
+
+    bool Pixel_Map::Is_Bad(const Frame_View& my_Frame, int x, int y) const{
+        Bad_Columns bad = Bad_In_Row(my_Frame, y);
+        return std::binary_search(bad.first, bad.last, x + bad.offset);
+    }
+
+    const uint16_t* Pixel_Map::Column_Offsets(const Frame_View& my_Frame) const{
+        if (column_Offsets.empty() || (my_Frame.bits_Per_Pixel != bits_Per_Pixel) ||
+            (my_Frame.offset_X < 0) || (my_Frame.offset_X + my_Frame.width > width)){
+            return nullptr;
+        }
+        return column_Offsets.data() + my_Frame.offset_X;
+    }
+
+    int Pixel_Map::Save(std::string file_Name) const{
+        std::ofstream file_Out(file_Name, std::ofstream::binary);
+        if (!file_Out.is_open()){
+            std::cout << "Couldn't save pixel map to " << file_Name << "\n";
+            return 1;
+        }
+        File_Header header;
+        std::copy(file_Magic, file_Magic + 4, header.magic);
+        header.version = file_Version;
+        header.width = width;
+        header.height = height;
+        header.bits_Per_Pixel = bits_Per_Pixel;
+        header.n_Bad_Pixels = bad_Cols.size();
+        header.n_Column_Offsets = column_Offsets.size();
+        file_Out.write((const char*)&header, sizeof(header));
+        Write_Vector(file_Out, row_Start);
+        Write_Vector(file_Out, bad_Cols);
+        Write_Vector(file_Out, column_Offsets);
+        if (!file_Out.good()){
+            std::cout << "Error writing pixel map to " << file_Name << "\n";
+            return 1;
+        }
+        std::cout << "Pixel map saved to " << file_Name << "\n";
+        return 0;
+    }
+
+    int Pixel_Map::Load(std::string file_Name){
+        std::ifstream file_In(file_Name, std::ifstream::binary);
+        if (!file_In.is_open()){
+            std::cout << "No pixel map " << file_Name << ", pixels won't be corrected" << "\n";
+            return 1;
+        }
+        File_Header header;
+        file_In.read((char*)&header, sizeof(header));
+        if (!file_In.good() || !std::equal(file_Magic, file_Magic + 4, header.magic) ||
+            (header.version != file_Version) || (header.width <= 0) || (header.height <= 0) ||
+            (header.n_Bad_Pixels < 0) || (header.n_Column_Offsets < 0)){
+            std::cout << file_Name << " isn't a pixel map this version understands" << "\n";
+            return 1;
+        }
+
+        std::vector<uint32_t> file_Row_Start;
+        std::vector<uint16_t> file_Bad_Cols;
+        std::vector<uint16_t> file_Column_Offsets;
+        Read_Vector(file_In, file_Row_Start, header.height + 1);
+        Read_Vector(file_In, file_Bad_Cols, header.n_Bad_Pixels);
+        Read_Vector(file_In, file_Column_Offsets, header.n_Column_Offsets);
+        if (!file_In.good() || (file_Row_Start.back() != file_Bad_Cols.size()) ||
+            ((header.n_Column_Offsets != 0) && (header.n_Column_Offsets != header.width))){
+            std::cout << file_Name << " is corrupt" << "\n";
+            return 1;
+        }
+
+        width = header.width;
+        height = header.height;
+        bits_Per_Pixel = header.bits_Per_Pixel;
+        row_Start.swap(file_Row_Start);
+        bad_Cols.swap(file_Bad_Cols);
+        column_Offsets.swap(file_Column_Offsets);
+        std::cout << "Loaded pixel map from " << file_Name << ", " << bad_Cols.size() << " bad pixels" << "\n";
+        return 0;
+    }
+
+} // namespace LD_Camera
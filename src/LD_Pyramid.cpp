@@ -0,0 +1,47 @@
+#include "LD_Pyramid.h"
+#include "LD_RowKernels.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace LD_QuarcTracker{
+    int Build_Pyramid(const LD_Camera::Frame_View& my_Frame, int factor, Pyramid_Image& small_Image){
+        if ((factor < 1) || (factor > max_Pyramid_Factor)){
+            std::cout << "Pyramid factor " << factor << " not supported (1 to "
+                      << max_Pyramid_Factor << ")" << "\n";
+            return 1;
+        }
+
+        small_Image.factor = factor;
+        small_Image.width = my_Frame.width / factor;
+        small_Image.height = my_Frame.height / factor;
+        small_Image.sums.resize(small_Image.width * small_Image.height);
+        if (!my_Frame.Valid() || (small_Image.width == 0) || (small_Image.height == 0)){
+            return 0;
+        }
+
+        for(int small_Row=0; small_Row < small_Image.height; small_Row++){
+            Box_Sum_Band(my_Frame.Row(small_Row * factor), my_Frame.stride, my_Frame.bits_Per_Pixel,
+                         factor, small_Image.width, small_Image.sums.data() + (small_Row * small_Image.width));
+        }
+        return 0;
+    }
+
+    bool Brightest_Block(const Pyramid_Image& small_Image, int& x, int& y){
+        if (small_Image.sums.empty()){
+            return false;
+        }
+        // Find the biggest value then where it is, rather than both at once.
+        // The first loop has no branches so the compiler can vectorise it.
+        const std::vector<uint32_t>& sums = small_Image.sums;
+        uint32_t brightest_Sum = 0;
+        for(unsigned int i=0; i < sums.size(); i++){
+            brightest_Sum = std::max(brightest_Sum, sums[i]);
+        }
+        int brightest = std::find(sums.begin(), sums.end(), brightest_Sum) - sums.begin();
+        x = (brightest % small_Image.width) * small_Image.factor + (small_Image.factor / 2);
+        y = (brightest / small_Image.width) * small_Image.factor + (small_Image.factor / 2);
+        return true;
+    }
+
+} // namespace LD_QuarcTracker
@@ -59,6 +59,15 @@ namespace LD_QuarcTracker{
             tracker_Ini.GetReal("Camera Settings", "FrameRate_AOI", 60);
         my_Options.camera_Options.exposure_AOI.exposure =
             tracker_Ini.GetReal("Camera Settings", "Exposure", 1);
+        // How many image memories the driver gets to cycle through.
+        my_Options.camera_Options.n_Buffers =
+            tracker_Ini.GetInteger("Camera Settings", "Ring_Buffers", 4);
+        // Free running capture overlaps the next exposure with processing.
+        my_Options.camera_Options.continuous_Capture =
+            tracker_Ini.GetBoolean("Camera Settings", "Continuous_Capture", false);
+        // Bad pixel calibration, 'c' while tracking makes a new one.
+        my_Options.camera_Options.pixel_Map_File =
+            tracker_Ini.Get("Camera Settings", "Pixel_Map_File", "");
 
         // Not much to set for the mirror, most of the settings are hard coded
         // in the driver since they are hardware dependent.
@@ -77,6 +86,13 @@ namespace LD_QuarcTracker{
         // on/off state directly.
         my_Options.tracker_Options.tracker_Period =
             tracker_Ini.GetInteger("Tracker Options", "Tracker_Period", 0);
+        // How the 'c' key calibrates the pixel map.
+        my_Options.tracker_Options.pixel_Map_Frames =
+            tracker_Ini.GetInteger("Camera Settings", "Pixel_Map_Frames", 50);
+        my_Options.tracker_Options.hot_Pixel_Thresh =
+            tracker_Ini.GetReal("Camera Settings", "Hot_Pixel_Thresh", 50);
+        my_Options.tracker_Options.stuck_Pixel_Fraction =
+            tracker_Ini.GetReal("Camera Settings", "Stuck_Pixel_Fraction", 0.1);
         // An option to never enable the  AOI if preferrred.
         my_Options.tracker_Options.do_AOI =
             tracker_Ini.GetBoolean("Tracker Options", "do_AOI", false);
@@ -90,19 +106,20 @@ namespace LD_QuarcTracker{
         // PID parameters for closed loop control. separate for full frame
         // and AOI.
         my_Options.tracker_Options.full_PID_Options.P =
-            tracker_Ini.GetReal("Tracker Options", "pid_P", 0.1);
+            tracker_Ini.GetReal("Tracker Options", "pid_P", 0);
         my_Options.tracker_Options.full_PID_Options.I =
-            tracker_Ini.GetReal("Tracker Options", "pid_I", 0);
+            tracker_Ini.GetReal("Tracker Options", "pid_I", 0.006);
         my_Options.tracker_Options.full_PID_Options.D =
             tracker_Ini.GetReal("Tracker Options", "pid_D", 0);
-        my_Options.tracker_Options.full_PID_Options.constant_Time = true;
+        my_Options.tracker_Options.full_PID_Options.D_Filter_Time =
+            tracker_Ini.GetReal("Tracker Options", "pid_D_Filter", 0.01);
         my_Options.tracker_Options.full_PID_Options.min_Output =
             -my_Options.mirror_Options.limit;
         my_Options.tracker_Options.full_PID_Options.max_Output =
             my_Options.mirror_Options.limit;
 
         my_Options.tracker_Options.aoi_PID_Options.P =
-            tracker_Ini.GetReal("Tracker Options", "pid_P_aoi", 0.1);
+            tracker_Ini.GetReal("Tracker Options", "pid_P_aoi", 0);
         my_Options.tracker_Options.aoi_PID_Options.I =
             tracker_Ini.GetReal("Tracker Options", "pid_I_aoi", 0);
         my_Options.tracker_Options.aoi_PID_Options.D =
@@ -116,7 +133,8 @@ namespace LD_QuarcTracker{
             my_Options.tracker_Options.aoi_PID_Options =
                 my_Options.tracker_Options.full_PID_Options;
         }
-        my_Options.tracker_Options.aoi_PID_Options.constant_Time = true;
+        my_Options.tracker_Options.aoi_PID_Options.D_Filter_Time =
+            my_Options.tracker_Options.full_PID_Options.D_Filter_Time;
         my_Options.tracker_Options.aoi_PID_Options.min_Output =
             -my_Options.mirror_Options.limit;
         my_Options.tracker_Options.aoi_PID_Options.max_Output =
@@ -139,7 +157,76 @@ namespace LD_QuarcTracker{
         // Dump out spot profiles for diagnostics?
         my_Options.tracker_Options.full_Spot_Finder.save_Data =
             tracker_Ini.GetBoolean("Spot Detection", "gaussian_SaveData", false);
-
+        // Single sweep projection, and whether to check it against the
+        // straightforward version every frame (slow, for debugging).
+        my_Options.tracker_Options.full_Spot_Finder.fused_Kernel =
+            tracker_Ini.GetBoolean("Spot Detection", "fused_Kernel", true);
+        my_Options.tracker_Options.full_Spot_Finder.validate_Kernel =
+            tracker_Ini.GetBoolean("Spot Detection", "validate_Kernel", false);
+        // Single pass thresholding from the previous frame's maximum.
+        my_Options.tracker_Options.full_Spot_Finder.predict_Thresh =
+            tracker_Ini.GetBoolean("Spot Detection", "predict_Thresh", false);
+        my_Options.tracker_Options.full_Spot_Finder.rescan_Fraction =
+            tracker_Ini.GetReal("Spot Detection", "rescan_Fraction", 0.1);
+        // Search near the last spot before the whole frame.
+        my_Options.tracker_Options.full_Spot_Finder.roi_Search =
+            tracker_Ini.GetBoolean("Spot Detection", "roi_Search", false);
+        my_Options.tracker_Options.full_Spot_Finder.roi_Size =
+            tracker_Ini.GetInteger("Spot Detection", "roi_Size", 128);
+        // Coarse to fine search on a shrunk copy of the frame.
+        my_Options.tracker_Options.full_Spot_Finder.pyramid_Search =
+            tracker_Ini.GetBoolean("Spot Detection", "pyramid_Search", false);
+        my_Options.tracker_Options.full_Spot_Finder.pyramid_Factor =
+            tracker_Ini.GetInteger("Spot Detection", "pyramid_Factor", 8);
+        my_Options.tracker_Options.full_Spot_Finder.pyramid_Window =
+            tracker_Ini.GetInteger("Spot Detection", "pyramid_Window", 128);
+        my_Options.tracker_Options.full_Spot_Finder.sparse_Search =
+            tracker_Ini.GetBoolean("Spot Detection", "sparse_Search", false);
+        my_Options.tracker_Options.full_Spot_Finder.sparse_Spot_Size =
+            tracker_Ini.GetInteger("Spot Detection", "sparse_Spot_Size", 16);
+        my_Options.tracker_Options.full_Spot_Finder.sparse_Min_Pixels =
+            tracker_Ini.GetInteger("Spot Detection", "sparse_Min_Pixels", 262144);
+        // Centroid, fit a gaussian round it, or interpolate the projection peaks.
+        my_Options.tracker_Options.full_Spot_Finder.estimator =
+            Estimator_From_Name(tracker_Ini.Get("Spot Detection", "estimator", "centroid"));
+        my_Options.tracker_Options.full_Spot_Finder.fit_Window =
+            tracker_Ini.GetInteger("Spot Detection", "fit_Window", 32);
+        my_Options.tracker_Options.full_Spot_Finder.fit_Max_Iterations =
+            tracker_Ini.GetInteger("Spot Detection", "fit_Max_Iterations", 20);
+        my_Options.tracker_Options.full_Spot_Finder.window_Half_Width =
+            tracker_Ini.GetInteger("Spot Detection", "window_Half_Width", 10);
+        // Pick the spot out of several blobs.
+        my_Options.tracker_Options.full_Spot_Finder.blob_Detection =
+            tracker_Ini.GetBoolean("Spot Detection", "blob_Detection", false);
+        my_Options.tracker_Options.full_Spot_Finder.blob_Ranking =
+            Blob_Ranking_From_Name(tracker_Ini.Get("Spot Detection", "blob_Ranking", "brightest"));
+        my_Options.tracker_Options.full_Spot_Finder.blob_Expected_Area =
+            tracker_Ini.GetInteger("Spot Detection", "blob_Expected_Area", 100);
+        // Running background, taken off before thresholding.
+        my_Options.tracker_Options.full_Spot_Finder.background_Subtract =
+            tracker_Ini.GetBoolean("Spot Detection", "background_Subtract", false);
+        my_Options.tracker_Options.full_Spot_Finder.background_Frames =
+            tracker_Ini.GetInteger("Spot Detection", "background_Frames", 64);
+        my_Options.tracker_Options.full_Spot_Finder.background_Update_Period =
+            tracker_Ini.GetInteger("Spot Detection", "background_Update_Period", 10);
+        my_Options.tracker_Options.full_Spot_Finder.background_Skip =
+            tracker_Ini.GetInteger("Spot Detection", "background_Skip", 64);
+        my_Options.tracker_Options.full_Spot_Finder.background_Path =
+            tracker_Ini.Get("Spot Detection", "background_Path", "");
+        my_Options.tracker_Options.full_Spot_Finder.pixel_Map_Correct =
+            tracker_Ini.GetBoolean("Spot Detection", "pixel_Map_Correct", false);
+        my_Options.tracker_Options.full_Spot_Finder.adaptive_Thresh =
+            tracker_Ini.GetBoolean("Spot Detection", "adaptive_Thresh", false);
+        my_Options.tracker_Options.full_Spot_Finder.noise_Sigmas =
+            tracker_Ini.GetReal("Spot Detection", "noise_Sigmas", 5);
+        my_Options.tracker_Options.full_Spot_Finder.fixed_Kernels =
+            tracker_Ini.GetBoolean("Spot Detection", "fixed_Kernels", true);
+        my_Options.tracker_Options.full_Spot_Finder.spot_Metrics =
+            tracker_Ini.GetBoolean("Spot Detection", "spot_Metrics", false);
+
+        // The AOI spot finder is the same apart from its thresholds.
+        my_Options.tracker_Options.aoi_Spot_Finder =
+            my_Options.tracker_Options.full_Spot_Finder;
         // Spot finder for AOI will have less systematic background because
         // the frame is smaller but the entire spot is still (hopefully) in
         // the AOI. The thresholds could probably be set a bit more gently.
@@ -147,15 +234,27 @@ namespace LD_QuarcTracker{
             tracker_Ini.GetReal("Spot Detection", "peak_Thresh_AOI", 0.5);
         my_Options.tracker_Options.aoi_Spot_Finder.gaussian_Thresh =
             tracker_Ini.GetReal("Spot Detection", "gaussian_Thresh_AOI", 0.5);
-        my_Options.tracker_Options.aoi_Spot_Finder.n_Peak_Pixels =
-            tracker_Ini.GetReal("Spot Detection", "nPeakPixels", 500);
-        my_Options.tracker_Options.aoi_Spot_Finder.save_Data =
-            tracker_Ini.GetBoolean("Spot Detection", "gaussian_SaveData", false);
 
         // If HAVE_OPENCV is defined, the display mode determines how much
         // detail is plotted with the camera feed by opencv.
         my_Options.tracker_Options.display_Mode =
             tracker_Ini.GetInteger("Tracker Options", "Display_Mode", 2);
+        my_Options.tracker_Options.display_Options.max_Rate =
+            tracker_Ini.GetReal("Tracker Options", "Display_Rate", 30);
+        my_Options.tracker_Options.display_Options.black_Level =
+            tracker_Ini.GetInteger("Tracker Options", "Display_Black", 0);
+        my_Options.tracker_Options.display_Options.white_Level =
+            tracker_Ini.GetInteger("Tracker Options", "Display_White", 0);
+        my_Options.tracker_Options.display_Options.gamma =
+            tracker_Ini.GetReal("Tracker Options", "Display_Gamma", 1);
+        my_Options.tracker_Options.display_Options.decimation =
+            tracker_Ini.GetInteger("Tracker Options", "Display_Decimation", 1);
+
+        // Shared memory telemetry for external viewers, off unless named.
+        my_Options.tracker_Options.telemetry_Name =
+            tracker_Ini.Get("Tracker Options", "Telemetry_Name", "");
+        my_Options.tracker_Options.telemetry_Slots =
+            tracker_Ini.GetInteger("Tracker Options", "Telemetry_Slots", 4);
 
         return my_Options;
     }
@@ -218,10 +317,25 @@ namespace LD_QuarcTracker{
 
 
         display_Mode = my_Options.tracker_Options.display_Mode;
+        display_Options = my_Options.tracker_Options.display_Options;
         tracker_Period = my_Options.tracker_Options.tracker_Period;
+        pixel_Map_Frames = my_Options.tracker_Options.pixel_Map_Frames;
+        hot_Pixel_Thresh = my_Options.tracker_Options.hot_Pixel_Thresh;
+        stuck_Pixel_Fraction = my_Options.tracker_Options.stuck_Pixel_Fraction;
+
+        if (!my_Options.tracker_Options.telemetry_Name.empty()){
+            // Big enough for a full frame.
+            LD_Camera::AOI sensor = my_Camera.Get_Sensor_Size();
+            uint32_t bytes_Per_Pixel = (my_Options.camera_Options.bits_Per_Pixel > 8) ? 2 : 1;
+            my_Telemetry.Open(my_Options.tracker_Options.telemetry_Name,
+                              my_Options.tracker_Options.telemetry_Slots,
+                              sensor.aoi_Size.s32Width * sensor.aoi_Size.s32Height * bytes_Per_Pixel);
+        }
 
-        pid_X.InitPID(my_Options.tracker_Options.full_PID_Options);
-        pid_Y.InitPID(my_Options.tracker_Options.full_PID_Options);
+        full_PID_Options = my_Options.tracker_Options.full_PID_Options;
+        aoi_PID_Options = my_Options.tracker_Options.aoi_PID_Options;
+        pid_X.InitPID(full_PID_Options);
+        pid_Y.InitPID(full_PID_Options);
 
         return 0;
     }
@@ -239,21 +353,28 @@ namespace LD_QuarcTracker{
 
         uint64_t step = 0;
         keep_Running = true;
+        #ifdef HAVE_OPENCV
+        my_Display.Start(display_Options);
+        #endif // HAVE_OPENCV
         while(keep_Running){
             timer_Loop.Start_Timer();
             //std::cout << "Start step " << step << std::endl;
             // Take camera image, react to it (aoi, mirror etc)
             Fine_Track_Step();
+            Publish_Telemetry(step);
 
             #ifdef HAVE_OPENCV
-            // If openCV is available (and wanted), display the camera image in
-            // a window with some decorations (re: display_Mode) and watch for
-            // keypresses in the window used for control.
-            kb_Hit = my_Camera.Show_Image(display_Mode);
-
-            // Check if there was a keyboard press during the display and if
-            // so, whether to do anything about it.
-            Keyboard_Handler(kb_Hit);
+            // If openCV is available (and wanted), the display thread shows
+            // the camera image in a window with some decorations (re:
+            // display_Mode) and watches for keypresses in the window used
+            // for control. Neither waits for the window.
+            Post_Display();
+
+            // Check if there were any keyboard presses since last time and if
+            // so, whether to do anything about them.
+            while (my_Display.Next_Key(kb_Hit)){
+                Keyboard_Handler(kb_Hit);
+            }
             #endif // HAVE_OPENCV
 
             step++;
@@ -286,6 +407,10 @@ namespace LD_QuarcTracker{
 
         }
 
+        #ifdef HAVE_OPENCV
+        my_Display.Stop();
+        #endif // HAVE_OPENCV
+
         // Loop's over, now save the std::list of the loop data to csv.
         Save_Datafile("tracker_Data.csv");
 
@@ -307,11 +432,14 @@ namespace LD_QuarcTracker{
     int Tracker::Fine_Track_Step(){
 
         timer_Camera.Start_Timer();
-        my_Camera.Take_Picture();
+        int picture_Ret = my_Camera.Take_Picture();
         timer_Camera.Stop_Timer();
-        // Maybe this should return a struct rather than returning a bool
-        // and then the spot coords by reference?
-        spot_Found = my_Camera.Spot_Finder(spot_Coords);
+        if (picture_Ret != 0){
+            // No frame to look at this step, leave everything as it was.
+            return 1;
+        }
+        spot_Result = my_Camera.Spot_Finder(spot_Coords);
+        spot_Found = spot_Result.found;
 
         // spot_Coords is nonsense if the spot wasn't found.
         if (spot_Found){
@@ -324,16 +452,31 @@ namespace LD_QuarcTracker{
             // And obviously don't move the mirror either.
             if (tracker_On){
                 timer_Mirror.Start_Timer();
-                move_X = pid_X.UpdatePID(spot_Error.x);
-                mirror_X += move_X;
-                move_Y = pid_Y.UpdatePID(spot_Error.y);
-                mirror_Y += move_Y;
+                if (!pid_Running){
+                    // Just turned on (or back on after losing the spot),
+                    // carry on from wherever the mirror is now.
+                    pid_X.ResetPID(mirror_X);
+                    pid_Y.ResetPID(mirror_Y);
+                    pid_Running = true;
+                }
+                // The PIDs work out where the mirror should be, in real time
+                // from when the frame was taken.
+                double frame_Time = my_Camera.Get_Frame().capture_Time;
+                float new_X = pid_X.UpdatePID(spot_Error.x, spot_Coords.x, frame_Time);
+                float new_Y = pid_Y.UpdatePID(spot_Error.y, spot_Coords.y, frame_Time);
+                move_X = new_X - mirror_X;
+                move_Y = new_Y - mirror_Y;
+                mirror_X = new_X;
+                mirror_Y = new_Y;
                 //std::cout << "Move by: " << move_X << ", " << move_Y << std::endl;
                 //std::cout << "Mirror pos: " << mirror_X << ", " << mirror_Y << std::endl;
 
                 my_Mirror.Move(mirror_X, mirror_Y);
                 timer_Mirror.Stop_Timer();
             }
+            else{
+                pid_Running = false;
+            }
 
             if (use_AOI && !my_Camera.aoi_Set){
                 // If AOI is required, check if the spot fulfils the criteria
@@ -345,12 +488,21 @@ namespace LD_QuarcTracker{
                 if (spot_Inside_AOI){
                     my_Camera.Enable_AOI();
                     Set_Setpoint(aoi_Setpoint);
+                    // Spot co-ordinates are on the AOI now.
+                    pid_X.ChangePID(aoi_PID_Options);
+                    pid_Y.ChangePID(aoi_PID_Options);
                 }
             }
         }
         else{
-            std::cout << "Spot not found" << "\n";
+            std::cout << "Spot not found (" << Spot_Failure_Name(spot_Result.failure)
+                      << ", peak " << spot_Result.peak << ", snr " << spot_Result.snr
+                      << ", " << spot_Result.n_Peak_Pixels << " pixels over threshold "
+                      << spot_Result.threshold << ")" << "\n";
             no_Spot_Counter++;
+            // Start the PIDs again from wherever the mirror is when the spot
+            // comes back.
+            pid_Running = false;
 
             my_Camera.Save_Picture("Error.bin", true);
             if (my_Camera.aoi_Set){
@@ -359,6 +511,8 @@ namespace LD_QuarcTracker{
                 // frame.
                 my_Camera.Disable_AOI();
                 Set_Setpoint(full_Setpoint);
+                pid_X.ChangePID(full_PID_Options);
+                pid_Y.ChangePID(full_PID_Options);
                 // TODO: Enact a search pattern (lissajous figure?) if the spot
                 // isn't on the full frame either. At least reset the mirror to
                 // the origin.
@@ -379,15 +533,34 @@ namespace LD_QuarcTracker{
     int Tracker::Live_Camera(){
         #ifdef HAVE_OPENCV
         // Just show the raw image from the camera and don't do anything else.
+        display_Mode = 0;
+        my_Display.Start(display_Options);
         while(true){
             my_Camera.Take_Picture();
             //my_Camera.Save_Picture("test.bin", true);
-            my_Camera.Show_Image(0);
+            Post_Display();
+            // Nothing to do with the keys, but don't let them pile up.
+            while (my_Display.Next_Key(kb_Hit)){
+            }
         }
         #endif //HAVE_OPENCV
         return 0;
     }
 
+    #ifdef HAVE_OPENCV
+    int Tracker::Post_Display(){
+        Display_Overlay overlay;
+        overlay.display_Mode = display_Mode;
+        overlay.spot_Found = spot_Found;
+        overlay.spot_Coords = spot_Coords;
+        overlay.setpoint = active_Setpoint;
+        overlay.aoi_Set = my_Camera.aoi_Set;
+        // The camera's copy, not a camera API call.
+        overlay.aoi = my_Camera.Get_AOI_Info();
+        return my_Display.Post_Frame(my_Camera.Get_Frame(), overlay);
+    }
+    #endif // HAVE_OPENCV
+
     int Tracker::Keyboard_Handler(int kb_Hit){
             switch (kb_Hit){
             case 255: // no key
@@ -406,6 +579,15 @@ namespace LD_QuarcTracker{
                 }
                 tracker_On = !tracker_On;
                 break;
+            case 99: // c
+                if (tracker_On){
+                    std::cout << "Can't calibrate the pixel map while tracking" << "\n";
+                    std::cout << "press \'t\' to turn the tracker off and cover the camera first" << "\n";
+                }
+                else{
+                    my_Camera.Calibrate_Pixel_Map(pixel_Map_Frames, hot_Pixel_Thresh, stuck_Pixel_Fraction);
+                }
+                break;
             case 81: // left
             case 82: // up
             case 83: // right
@@ -446,9 +628,33 @@ namespace LD_QuarcTracker{
         return my_Mirror.Move(mirror_X, mirror_Y);
     }
 
+    int Tracker::Publish_Telemetry(uint64_t step_Number){
+        if (!my_Telemetry.Is_Open()){
+            return 0;
+        }
+        Telemetry_Values values = Telemetry_Values();
+        values.step_Number = step_Number;
+        const LD_Camera::Frame_View& my_Frame = my_Camera.Get_Frame();
+        values.frame_ID = my_Frame.frame_ID;
+        values.flags = (spot_Found ? telemetry_Spot_Found : 0) |
+                       (tracker_On ? telemetry_Tracker_On : 0) |
+                       (my_Camera.aoi_Set ? telemetry_AOI_Set : 0);
+        values.spot_X = spot_Coords.x;
+        values.spot_Y = spot_Coords.y;
+        values.error_X = spot_Error.x;
+        values.error_Y = spot_Error.y;
+        values.mirror_X = mirror_X;
+        values.mirror_Y = mirror_Y;
+        return my_Telemetry.Publish(values, my_Frame);
+    }
+
     int Tracker::Fill_DataList(uint64_t step_Number){
         // All information I can think of that's worth outputting per cycle
         // of the tracker.
+        uint64_t image_Copies = my_Camera.Get_Image_Copies();
+        uint64_t threshold_Rescans = my_Camera.Get_Threshold_Rescans();
+        Gauss_Fit_Result last_Fit = my_Camera.Get_Last_Fit();
+        int n_Blobs = my_Camera.Get_Blob_Count();
         tracker_Data.push_back({
             step_Number,
             spot_Coords.x,
@@ -462,15 +668,33 @@ namespace LD_QuarcTracker{
             my_Camera.aoi_Set,
             timer_Camera.Get_Last_Time_Difference(),
             timer_Mirror.Get_Last_Time_Difference(),
-            timer_Loop.Get_Last_Time_Difference()
+            timer_Loop.Get_Last_Time_Difference(),
+            (int)(image_Copies - last_Image_Copies),
+            (int)(threshold_Rescans - last_Threshold_Rescans),
+            (float)last_Fit.residual,
+            last_Fit.iterations,
+            n_Blobs,
+            spot_Result.failure,
+            spot_Result.peak,
+            spot_Result.n_Saturated,
+            spot_Result.snr,
+            spot_Result.background,
+            spot_Result.width_X,
+            spot_Result.width_Y,
+            spot_Result.ellipticity,
+            spot_Result.threshold,
+            spot_Result.noise_Floor,
+            spot_Result.bytes_Read
         });
+        last_Image_Copies = image_Copies;
+        last_Threshold_Rescans = threshold_Rescans;
         return 0;
     }
 
     int Tracker::Save_Datafile(std::string filename){
             std::cout << "Saving data file" << "\n";
             std::ofstream tracker_Data_File(filename);
-            tracker_Data_File << "Step, Spot X, Spot Y, Error X, Error Y, Mirror X, Mirror Y, Tracker On?, Spot Found?, AOI on?, t_Camera, t_Mirror, t_Loop\n";
+            tracker_Data_File << "Step, Spot X, Spot Y, Error X, Error Y, Mirror X, Mirror Y, Tracker On?, Spot Found?, AOI on?, t_Camera, t_Mirror, t_Loop, Image Copies, Threshold Rescans, Fit Residual, Fit Iterations, Blobs, Spot Failure, Spot Peak, Saturated Pixels, Spot SNR, Background, Spot Width X, Spot Width Y, Spot Ellipticity, Threshold, Noise Floor, Bytes Read\n";
             for(auto data_Step : tracker_Data){
                 tracker_Data_File << data_Step.step_Number << ", " <<
                     data_Step.spot_X << ",  " <<
@@ -484,7 +708,23 @@ namespace LD_QuarcTracker{
                     data_Step.is_AOI << ", " <<
                     data_Step.time_Camera << ", " <<
                     data_Step.time_Mirror << ", " <<
-                    data_Step.time_Loop
+                    data_Step.time_Loop << ", " <<
+                    data_Step.image_Copies << ", " <<
+                    data_Step.threshold_Rescans << ", " <<
+                    data_Step.fit_Residual << ", " <<
+                    data_Step.fit_Iterations << ", " <<
+                    data_Step.n_Blobs << ", " <<
+                    Spot_Failure_Name(data_Step.spot_Failure) << ", " <<
+                    data_Step.spot_Peak << ", " <<
+                    data_Step.n_Saturated << ", " <<
+                    data_Step.spot_SNR << ", " <<
+                    data_Step.spot_Background << ", " <<
+                    data_Step.spot_Width_X << ", " <<
+                    data_Step.spot_Width_Y << ", " <<
+                    data_Step.spot_Ellipticity << ", " <<
+                    data_Step.spot_Threshold << ", " <<
+                    data_Step.noise_Floor << ", " <<
+                    data_Step.bytes_Read
                     << "\n";
         }
         tracker_Data_File.close();
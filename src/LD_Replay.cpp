@@ -0,0 +1,108 @@
+#include "LD_Replay.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace LD_Camera{
+    Frame_Replay::Frame_Replay()
+    {
+        //ctor
+    }
+
+    Frame_Replay::~Frame_Replay()
+    {
+        //dtor
+    }
+
+    int Frame_Replay::Add_Frame(std::string file_Name, int width, int height, int bits_Per_Pixel,
+                                int offset_X, int offset_Y){
+        std::ifstream file_In(file_Name, std::ifstream::binary);
+        if (!file_In.is_open()){
+            std::cout << "Couldn't open replay frame " << file_Name << "\n";
+            return 1;
+        }
+
+        std::vector<uint8_t> file_Data((std::istreambuf_iterator<char>(file_In)),
+                                        std::istreambuf_iterator<char>());
+        file_In.close();
+
+        if (file_Data.size() != (unsigned int)(width * height * 2)){
+            std::cout << file_Name << " is " << file_Data.size() << " bytes, expected "
+                      << width * height * 2 << "\n";
+            return 1;
+        }
+
+        // Dump_Binary writes the most significant byte first.
+        std::vector<uint16_t> pixels(width * height);
+        for(unsigned int i=0; i < pixels.size(); i++){
+            pixels[i] = (file_Data[2*i] << 8) + file_Data[2*i + 1];
+        }
+
+        return Add_Frame(pixels, width, height, bits_Per_Pixel, offset_X, offset_Y);
+    }
+
+    int Frame_Replay::Add_Frame(const std::vector<uint16_t> &pixels, int width, int height, int bits_Per_Pixel,
+                                int offset_X, int offset_Y){
+        if (pixels.size() != (unsigned int)(width * height)){
+            std::cout << "Replay frame has " << pixels.size() << " pixels, expected "
+                      << width * height << "\n";
+            return 1;
+        }
+
+        Replay_Frame new_Frame;
+        new_Frame.view.width = width;
+        new_Frame.view.height = height;
+        new_Frame.view.offset_X = offset_X;
+        new_Frame.view.offset_Y = offset_Y;
+        new_Frame.view.bits_Per_Pixel = bits_Per_Pixel;
+        new_Frame.view.stride = width * new_Frame.view.Bytes_Per_Pixel();
+
+        // Put the pixels back how the driver would have written them.
+        new_Frame.buffer.resize(new_Frame.view.stride * height);
+        if (bits_Per_Pixel > 8){
+            int shift = new_Frame.view.Shift();
+            for(unsigned int i=0; i < pixels.size(); i++){
+                uint16_t raw = pixels[i] << shift;
+                new_Frame.buffer[2*i] = raw & 0xFF;
+                new_Frame.buffer[2*i + 1] = (raw >> 8) & 0xFF;
+            }
+        }
+        else{
+            for(unsigned int i=0; i < pixels.size(); i++){
+                new_Frame.buffer[i] = pixels[i] & 0xFF;
+            }
+        }
+
+        frames.push_back(new_Frame);
+        // The vector may have moved everything, fix up all the pointers.
+        for (auto &frame : frames){
+            frame.view.data = frame.buffer.data();
+        }
+        return 0;
+    }
+
+    int Frame_Replay::Num_Frames(){
+        return frames.size();
+    }
+
+    const Frame_View& Frame_Replay::Next_Frame(){
+        if (frames.empty()){
+            current_Frame = Frame_View();
+            return current_Frame;
+        }
+
+        frame_Index = (frame_Index + 1) % frames.size();
+        current_Frame = frames[frame_Index].view;
+        current_Frame.frame_ID = ++frame_Counter;
+        current_Frame.capture_Time = std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        return current_Frame;
+    }
+
+    const Frame_View& Frame_Replay::Get_Frame(){
+        return current_Frame;
+    }
+
+} // namespace LD_Camera
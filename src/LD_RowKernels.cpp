@@ -0,0 +1,1050 @@
+#include "LD_RowKernels.h"
+#include "LD_Histogram.h"
+
+#include <algorithm>
+
+#if LD_SIMD_X86
+#include <immintrin.h>
+#endif // LD_SIMD_X86
+
+namespace LD_QuarcTracker{
+    namespace{
+        // Plain versions, also used for the odd pixels at the end of a line.
+        // Pixel_T is uint8_t for MONO8 or uint16_t for MONO16.
+        //
+        // With Subtract the background is taken off each pixel first (down
+        // to 0, not wrapping round). Without it background isn't touched
+        // and can be nullptr.
+        template <bool Subtract>
+        inline const uint16_t* Offset(const uint16_t* background, int col){
+            return Subtract ? (background + col) : background;
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        inline uint16_t Pixel_Value(const Pixel_T* pixels, const uint16_t* background, int col, int shift){
+            uint16_t pixel = pixels[col] >> shift;
+            if (Subtract){
+                pixel = (pixel > background[col]) ? (pixel - background[col]) : 0;
+            }
+            return pixel;
+        }
+
+        // Biggest value a pixel can have, ie. saturated.
+        template <typename Pixel_T>
+        inline uint16_t Full_Scale(int shift){
+            return (Pixel_T)~0 >> shift;
+        }
+
+        // How many madds of squares of pixels up to full_Scale fit in 32 bit
+        // lanes before they have to be widened. 2048 for 10 bit pixels.
+        inline int Square_Block(uint16_t full_Scale){
+            uint64_t most = 2ull * full_Scale * full_Scale;
+            return std::max<uint64_t>(1, 0xFFFFFFFFull / std::max<uint64_t>(most, 1));
+        }
+
+        // With Sum the (corrected) pixels and their squares are added to
+        // sums, and the pixels which were saturated before correction are
+        // counted. Without it sums isn't touched and can be nullptr.
+        template <bool Subtract, bool Sum, typename Pixel_T>
+        uint16_t Row_Max_Scalar(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                                Row_Sums* sums){
+            uint16_t full_Scale = Full_Scale<Pixel_T>(shift);
+            uint16_t row_Max = 0;
+            for(int col=0; col < width; col++){
+                uint16_t pixel = Pixel_Value<Subtract>(pixels, background, col, shift);
+                row_Max = std::max(row_Max, pixel);
+                if (Sum){
+                    sums->total += pixel;
+                    sums->total_Squares += (uint32_t)pixel * pixel;
+                    sums->n_Saturated += ((pixels[col] >> shift) == full_Scale);
+                }
+            }
+            return row_Max;
+        }
+
+        // Count 8 bins, one into each bank in turn. Written out since -O2
+        // leaves the loops rolled up, which took 3 times as long.
+        static_assert(histogram_Banks == 4, "Count_8 is written out for 4 banks");
+        inline void Count_8(const uint16_t* bins, uint32_t* banks){
+            uint32_t* bank_1 = banks + histogram_Bank_Stride;
+            uint32_t* bank_2 = banks + (2 * histogram_Bank_Stride);
+            uint32_t* bank_3 = banks + (3 * histogram_Bank_Stride);
+            banks[bins[0]]++;
+            bank_1[bins[1]]++;
+            bank_2[bins[2]]++;
+            bank_3[bins[3]]++;
+            banks[bins[4]]++;
+            bank_1[bins[5]]++;
+            bank_2[bins[6]]++;
+            bank_3[bins[7]]++;
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        void Row_Histogram_Scalar(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                                  int bin_Shift, uint32_t* banks){
+            int col = 0;
+            for(; col + 8 <= width; col += 8){
+                uint16_t bins[8];
+                for(int i=0; i < 8; i++){
+                    bins[i] = Pixel_Value<Subtract>(pixels, background, col + i, shift) >> bin_Shift;
+                }
+                Count_8(bins, banks);
+            }
+            for(; col < width; col++){
+                banks[Pixel_Value<Subtract>(pixels, background, col, shift) >> bin_Shift]++;
+            }
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        int Project_Row_Scalar(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                               uint16_t thresh, uint32_t* col_Acc, uint32_t& row_Total){
+            int n_Pixels = 0;
+            for(int col=0; col < width; col++){
+                uint16_t pixel = Pixel_Value<Subtract>(pixels, background, col, shift);
+                // Multiply by the comparison rather than branch on it.
+                uint32_t keep = (pixel > thresh);
+                col_Acc[col] += keep * pixel;
+                row_Total += keep * pixel;
+                n_Pixels += keep;
+            }
+            return n_Pixels;
+        }
+
+        template <typename Pixel_T>
+        void Average_Row_Scalar(const Pixel_T* pixels, int width, int shift, int fraction_Bits, int rate_Shift,
+                                uint32_t* average, uint16_t* estimate){
+            uint32_t half = 1 << (fraction_Bits - 1);
+            for(int col=0; col < width; col++){
+                int32_t target = (int32_t)(pixels[col] >> shift) << fraction_Bits;
+                average[col] += (target - (int32_t)average[col]) >> rate_Shift;
+                estimate[col] = (average[col] + half) >> fraction_Bits;
+            }
+        }
+
+        // Sum factor x factor blocks, n_Blocks of them side by side starting
+        // at first_Row. stride is in Pixel_T, not bytes.
+        template <typename Pixel_T>
+        void Box_Sum_Band_Scalar(const Pixel_T* first_Row, int stride, int shift, int factor,
+                                 int n_Blocks, uint32_t* sums){
+            for(int block=0; block < n_Blocks; block++){
+                uint32_t block_Sum = 0;
+                const Pixel_T* pixels = first_Row + (block * factor);
+                for(int row=0; row < factor; row++){
+                    for(int col=0; col < factor; col++){
+                        block_Sum += pixels[col] >> shift;
+                    }
+                    pixels += stride;
+                }
+                sums[block] = block_Sum;
+            }
+        }
+
+        // Columns are numbered from first_Col. The running totals of the row
+        // are passed in and out so the SIMD versions can finish the line.
+        inline void Integral_Row_Scalar(const uint16_t* line, int width, uint16_t floor,
+                                        const uint32_t* above_I, uint32_t* sum_I, uint32_t& row_I){
+            for(int col=0; col < width; col++){
+                row_I += (line[col] > floor) ? (line[col] - floor) : 0;
+                sum_I[col] = above_I[col] + row_I;
+            }
+        }
+
+        #if LD_SIMD_X86
+        // There are no unsigned 16 bit compares before AVX512, flipping the
+        // top bit turns an unsigned compare into a signed one.
+        const short sign_Bit = (short)0x8000;
+
+        // Load 8 pixels as 16 bit values (already shifted down).
+        LD_TARGET_SSE2 inline __m128i Load_8(const uint8_t* pixels, __m128i /*count*/){
+            return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)pixels), _mm_setzero_si128());
+        }
+        LD_TARGET_SSE2 inline __m128i Load_8(const uint16_t* pixels, __m128i count){
+            return _mm_srl_epi16(_mm_loadu_si128((const __m128i*)pixels), count);
+        }
+
+        // Take the background off (saturating, so it stops at 0)
+        template <bool Subtract>
+        LD_TARGET_SSE2 inline __m128i Subtract_8(__m128i pixel, const uint16_t* background){
+            if (Subtract){
+                pixel = _mm_subs_epu16(pixel, _mm_loadu_si128((const __m128i*)background));
+            }
+            return pixel;
+        }
+
+        // And load with the background subtracted.
+        template <bool Subtract, typename Pixel_T>
+        LD_TARGET_SSE2 inline __m128i Load_8(const Pixel_T* pixels, const uint16_t* background, __m128i count){
+            return Subtract_8<Subtract>(Load_8(pixels, count), background);
+        }
+
+        // Unsigned 32 bit lanes added in pairs to make 64 bit ones.
+        LD_TARGET_SSE2 inline __m128i Widen_Epi32(__m128i v){
+            const __m128i zero = _mm_setzero_si128();
+            return _mm_add_epi64(_mm_unpacklo_epi32(v, zero), _mm_unpackhi_epi32(v, zero));
+        }
+
+        LD_TARGET_SSE2 inline int Sum_Epi32(__m128i v){
+            v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+            v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtsi128_si32(v);
+        }
+
+        // madd treats the pixels as signed, fine up to 15 bit pixels. The
+        // squares are widened to 64 bits every Square_Block vectors (once a
+        // line, mostly), the rest fit in their lanes for any sensible line.
+        template <bool Subtract, bool Sum, typename Pixel_T>
+        LD_TARGET_SSE2 uint16_t Row_Max_SSE2(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                                             Row_Sums* sums){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m128i flip = _mm_set1_epi16(sign_Bit);
+            const __m128i full_Scale = _mm_set1_epi16((short)Full_Scale<Pixel_T>(shift));
+            const __m128i ones = _mm_set1_epi16(1);
+            const __m128i zero = _mm_setzero_si128();
+            const int square_Block = Sum ? Square_Block(Full_Scale<Pixel_T>(shift)) : 0;
+            int block_Left = square_Block;
+            __m128i max_Acc = _mm_set1_epi16(sign_Bit);
+            __m128i sum_Acc = zero;
+            __m128i square_Block_Acc = zero;
+            __m128i square_Acc = zero;
+            __m128i saturated_Acc = zero;
+            int col = 0;
+            for(; col + 8 <= width; col += 8){
+                __m128i raw = Load_8(pixels + col, count);
+                __m128i pixel = Subtract_8<Subtract>(raw, Offset<Subtract>(background, col));
+                max_Acc = _mm_max_epi16(max_Acc, _mm_xor_si128(pixel, flip));
+                if (Sum){
+                    sum_Acc = _mm_add_epi32(sum_Acc, _mm_madd_epi16(pixel, ones));
+                    square_Block_Acc = _mm_add_epi32(square_Block_Acc, _mm_madd_epi16(pixel, pixel));
+                    saturated_Acc = _mm_sub_epi16(saturated_Acc, _mm_cmpeq_epi16(raw, full_Scale));
+                    if (--block_Left == 0){
+                        square_Acc = _mm_add_epi64(square_Acc, Widen_Epi32(square_Block_Acc));
+                        square_Block_Acc = zero;
+                        block_Left = square_Block;
+                    }
+                }
+            }
+            max_Acc = _mm_xor_si128(max_Acc, flip);
+            uint16_t lanes[8];
+            _mm_storeu_si128((__m128i*)lanes, max_Acc);
+            uint16_t row_Max = *std::max_element(lanes, lanes + 8);
+            if (Sum){
+                square_Acc = _mm_add_epi64(square_Acc, Widen_Epi32(square_Block_Acc));
+                uint64_t square_Lanes[2];
+                _mm_storeu_si128((__m128i*)square_Lanes, square_Acc);
+                sums->total += (uint32_t)Sum_Epi32(sum_Acc);
+                sums->total_Squares += square_Lanes[0] + square_Lanes[1];
+                sums->n_Saturated += Sum_Epi32(_mm_madd_epi16(saturated_Acc, ones));
+            }
+            return std::max(row_Max, Row_Max_Scalar<Subtract, Sum>(pixels + col, Offset<Subtract>(background, col),
+                                                                   width - col, shift, sums));
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        LD_TARGET_SSE2 void Row_Histogram_SSE2(const Pixel_T* pixels, const uint16_t* background, int width,
+                                               int shift, int bin_Shift, uint32_t* banks){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m128i bin_Count = _mm_cvtsi32_si128(bin_Shift);
+            alignas(16) uint16_t bins[8];
+            int col = 0;
+            for(; col + 8 <= width; col += 8){
+                __m128i pixel = Load_8<Subtract>(pixels + col, Offset<Subtract>(background, col), count);
+                _mm_store_si128((__m128i*)bins, _mm_srl_epi16(pixel, bin_Count));
+                Count_8(bins, banks);
+            }
+            Row_Histogram_Scalar<Subtract>(pixels + col, Offset<Subtract>(background, col), width - col,
+                                           shift, bin_Shift, banks);
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        LD_TARGET_SSE2 int Project_Row_SSE2(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                                            uint16_t thresh, uint32_t* col_Acc, uint32_t& row_Total){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m128i flip = _mm_set1_epi16(sign_Bit);
+            const __m128i flipped_Thresh = _mm_set1_epi16((short)(thresh ^ 0x8000));
+            const __m128i zero = _mm_setzero_si128();
+            __m128i row_Acc = zero;
+            __m128i n_Acc = zero;
+            int col = 0;
+            for(; col + 8 <= width; col += 8){
+                __m128i pixel = Load_8<Subtract>(pixels + col, Offset<Subtract>(background, col), count);
+                __m128i mask = _mm_cmpgt_epi16(_mm_xor_si128(pixel, flip), flipped_Thresh);
+                __m128i kept = _mm_and_si128(pixel, mask);
+                // mask is -1 where the pixel counts.
+                n_Acc = _mm_sub_epi16(n_Acc, mask);
+
+                __m128i kept_Lo = _mm_unpacklo_epi16(kept, zero);
+                __m128i kept_Hi = _mm_unpackhi_epi16(kept, zero);
+                __m128i* col_Ptr = (__m128i*)(col_Acc + col);
+                _mm_storeu_si128(col_Ptr, _mm_add_epi32(_mm_loadu_si128(col_Ptr), kept_Lo));
+                _mm_storeu_si128(col_Ptr + 1, _mm_add_epi32(_mm_loadu_si128(col_Ptr + 1), kept_Hi));
+                row_Acc = _mm_add_epi32(row_Acc, _mm_add_epi32(kept_Lo, kept_Hi));
+            }
+            row_Total += Sum_Epi32(row_Acc);
+            int n_Pixels = Sum_Epi32(_mm_madd_epi16(n_Acc, _mm_set1_epi16(1)));
+            return n_Pixels + Project_Row_Scalar<Subtract>(pixels + col, Offset<Subtract>(background, col),
+                                                           width - col, shift, thresh, col_Acc + col, row_Total);
+        }
+
+        // 4 or 8 wide blocks only. The rows of each 8 columns are added up in
+        // a register (16 bits is plenty, 8 rows of 10 bit pixels), then madd
+        // adds neighbouring columns as it widens to 32 bits.
+        template <typename Pixel_T>
+        LD_TARGET_SSE2 void Box_Sum_Band_SSE2(const Pixel_T* first_Row, int stride, int shift, int factor,
+                                              int n_Blocks, uint32_t* sums){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m128i ones = _mm_set1_epi16(1);
+            int blocks_Per_Load = 8 / factor;
+            int block = 0;
+            for(; block + blocks_Per_Load <= n_Blocks; block += blocks_Per_Load){
+                const Pixel_T* pixels = first_Row + (block * factor);
+                __m128i column_Sums = _mm_setzero_si128();
+                for(int row=0; row < factor; row++){
+                    column_Sums = _mm_add_epi16(column_Sums, Load_8(pixels, count));
+                    pixels += stride;
+                }
+                __m128i pair_Sums = _mm_madd_epi16(column_Sums, ones);
+                if (factor == 8){
+                    sums[block] = Sum_Epi32(pair_Sums);
+                }
+                else{
+                    // [p0+p1, -, p2+p3, -]
+                    __m128i block_Sums = _mm_add_epi32(pair_Sums, _mm_shuffle_epi32(pair_Sums, _MM_SHUFFLE(2, 3, 0, 1)));
+                    sums[block] = _mm_cvtsi128_si32(block_Sums);
+                    sums[block + 1] = _mm_cvtsi128_si32(_mm_srli_si128(block_Sums, 8));
+                }
+            }
+            Box_Sum_Band_Scalar(first_Row + (block * factor), stride, shift, factor,
+                                n_Blocks - block, sums + block);
+        }
+
+        // The averages are 32 bit, so 8 pixels are two registers of them.
+        // Rounded back to 16 bits with packs, which is signed, so the values
+        // are moved down by 0x8000 first and back up after.
+        template <typename Pixel_T>
+        LD_TARGET_SSE2 void Average_Row_SSE2(const Pixel_T* pixels, int width, int shift, int fraction_Bits,
+                                             int rate_Shift, uint32_t* average, uint16_t* estimate){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m128i fraction = _mm_cvtsi32_si128(fraction_Bits);
+            const __m128i rate = _mm_cvtsi32_si128(rate_Shift);
+            const __m128i half = _mm_set1_epi32(1 << (fraction_Bits - 1));
+            const __m128i flip_32 = _mm_set1_epi32(0x8000);
+            const __m128i flip_16 = _mm_set1_epi16((short)0x8000);
+            const __m128i zero = _mm_setzero_si128();
+            int col = 0;
+            for(; col + 8 <= width; col += 8){
+                __m128i pixel = Load_8(pixels + col, count);
+                __m128i target_Lo = _mm_sll_epi32(_mm_unpacklo_epi16(pixel, zero), fraction);
+                __m128i target_Hi = _mm_sll_epi32(_mm_unpackhi_epi16(pixel, zero), fraction);
+                __m128i average_Lo = _mm_loadu_si128((const __m128i*)(average + col));
+                __m128i average_Hi = _mm_loadu_si128((const __m128i*)(average + col + 4));
+                average_Lo = _mm_add_epi32(average_Lo, _mm_sra_epi32(_mm_sub_epi32(target_Lo, average_Lo), rate));
+                average_Hi = _mm_add_epi32(average_Hi, _mm_sra_epi32(_mm_sub_epi32(target_Hi, average_Hi), rate));
+                _mm_storeu_si128((__m128i*)(average + col), average_Lo);
+                _mm_storeu_si128((__m128i*)(average + col + 4), average_Hi);
+
+                __m128i estimate_Lo = _mm_sub_epi32(_mm_srl_epi32(_mm_add_epi32(average_Lo, half), fraction), flip_32);
+                __m128i estimate_Hi = _mm_sub_epi32(_mm_srl_epi32(_mm_add_epi32(average_Hi, half), fraction), flip_32);
+                _mm_storeu_si128((__m128i*)(estimate + col),
+                                 _mm_xor_si128(_mm_packs_epi32(estimate_Lo, estimate_Hi), flip_16));
+            }
+            Average_Row_Scalar(pixels + col, width - col, shift, fraction_Bits, rate_Shift,
+                               average + col, estimate + col);
+        }
+
+        // Running totals of 4 pixel values (32 bit) with the total from the
+        // pixels before in carry_I, which is updated.
+        LD_TARGET_SSE2 inline void Integral_4_SSE2(__m128i pixel, int col, const uint32_t* above_I,
+                                                   uint32_t* sum_I, __m128i& carry_I){
+            // Prefix sum within the register, shift and add.
+            __m128i total = _mm_add_epi32(pixel, _mm_slli_si128(pixel, 4));
+            total = _mm_add_epi32(total, _mm_slli_si128(total, 8));
+            total = _mm_add_epi32(total, carry_I);
+            carry_I = _mm_shuffle_epi32(total, _MM_SHUFFLE(3, 3, 3, 3));
+            _mm_storeu_si128((__m128i*)(sum_I + col),
+                             _mm_add_epi32(_mm_loadu_si128((const __m128i*)(above_I + col)), total));
+        }
+
+        // 8 pixels at a time, as two lots of 4.
+        LD_TARGET_SSE2 void Integral_Row_SSE2(const uint16_t* line, int width, uint16_t floor,
+                                              const uint32_t* above_I, uint32_t* sum_I){
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i floor_16 = _mm_set1_epi16((short)floor);
+            __m128i carry_I = zero;
+            int col = 0;
+            for(; col + 8 <= width; col += 8){
+                __m128i pixel = _mm_subs_epu16(_mm_loadu_si128((const __m128i*)(line + col)), floor_16);
+                Integral_4_SSE2(_mm_unpacklo_epi16(pixel, zero), col, above_I, sum_I, carry_I);
+                Integral_4_SSE2(_mm_unpackhi_epi16(pixel, zero), col + 4, above_I, sum_I, carry_I);
+            }
+            uint32_t row_I = _mm_cvtsi128_si32(carry_I);
+            Integral_Row_Scalar(line + col, width - col, floor, above_I + col, sum_I + col, row_I);
+        }
+
+        // Load 16 pixels as 16 bit values (already shifted down).
+        LD_TARGET_AVX2 inline __m256i Load_16(const uint8_t* pixels, __m128i /*count*/){
+            return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)pixels));
+        }
+        LD_TARGET_AVX2 inline __m256i Load_16(const uint16_t* pixels, __m128i count){
+            return _mm256_srl_epi16(_mm256_loadu_si256((const __m256i*)pixels), count);
+        }
+
+        template <bool Subtract>
+        LD_TARGET_AVX2 inline __m256i Subtract_16(__m256i pixel, const uint16_t* background){
+            if (Subtract){
+                pixel = _mm256_subs_epu16(pixel, _mm256_loadu_si256((const __m256i*)background));
+            }
+            return pixel;
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        LD_TARGET_AVX2 inline __m256i Load_16(const Pixel_T* pixels, const uint16_t* background, __m128i count){
+            return Subtract_16<Subtract>(Load_16(pixels, count), background);
+        }
+
+        LD_TARGET_AVX2 inline __m256i Widen_Epi32(__m256i v){
+            return _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)),
+                                    _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+        }
+
+        LD_TARGET_AVX2 inline int Sum_Epi32(__m256i v){
+            __m128i half = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtsi128_si32(half);
+        }
+
+        template <bool Subtract, bool Sum, typename Pixel_T>
+        LD_TARGET_AVX2 uint16_t Row_Max_AVX2(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                                             Row_Sums* sums){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m256i full_Scale = _mm256_set1_epi16((short)Full_Scale<Pixel_T>(shift));
+            const __m256i ones = _mm256_set1_epi16(1);
+            const int square_Block = Sum ? Square_Block(Full_Scale<Pixel_T>(shift)) : 0;
+            int block_Left = square_Block;
+            __m256i max_Acc = _mm256_setzero_si256();
+            __m256i sum_Acc = _mm256_setzero_si256();
+            __m256i square_Block_Acc = _mm256_setzero_si256();
+            __m256i square_Acc = _mm256_setzero_si256();
+            __m256i saturated_Acc = _mm256_setzero_si256();
+            int col = 0;
+            for(; col + 16 <= width; col += 16){
+                __m256i raw = Load_16(pixels + col, count);
+                __m256i pixel = Subtract_16<Subtract>(raw, Offset<Subtract>(background, col));
+                max_Acc = _mm256_max_epu16(max_Acc, pixel);
+                if (Sum){
+                    sum_Acc = _mm256_add_epi32(sum_Acc, _mm256_madd_epi16(pixel, ones));
+                    square_Block_Acc = _mm256_add_epi32(square_Block_Acc, _mm256_madd_epi16(pixel, pixel));
+                    saturated_Acc = _mm256_sub_epi16(saturated_Acc, _mm256_cmpeq_epi16(raw, full_Scale));
+                    if (--block_Left == 0){
+                        square_Acc = _mm256_add_epi64(square_Acc, Widen_Epi32(square_Block_Acc));
+                        square_Block_Acc = _mm256_setzero_si256();
+                        block_Left = square_Block;
+                    }
+                }
+            }
+            __m128i half = _mm_max_epu16(_mm256_castsi256_si128(max_Acc), _mm256_extracti128_si256(max_Acc, 1));
+            // minpos finds the minimum, so look for the minimum of the
+            // inverted values.
+            half = _mm_minpos_epu16(_mm_xor_si128(half, _mm_set1_epi16(-1)));
+            uint16_t row_Max = ~_mm_extract_epi16(half, 0);
+            if (Sum){
+                square_Acc = _mm256_add_epi64(square_Acc, Widen_Epi32(square_Block_Acc));
+                uint64_t square_Lanes[4];
+                _mm256_storeu_si256((__m256i*)square_Lanes, square_Acc);
+                sums->total += (uint32_t)Sum_Epi32(sum_Acc);
+                sums->total_Squares += square_Lanes[0] + square_Lanes[1] + square_Lanes[2] + square_Lanes[3];
+                sums->n_Saturated += Sum_Epi32(_mm256_madd_epi16(saturated_Acc, ones));
+                // gcc leaves this out here, and the SSE code after pays for
+                // it dearly.
+                _mm256_zeroupper();
+            }
+            return std::max(row_Max, Row_Max_Scalar<Subtract, Sum>(pixels + col, Offset<Subtract>(background, col),
+                                                                   width - col, shift, sums));
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        LD_TARGET_AVX2 void Row_Histogram_AVX2(const Pixel_T* pixels, const uint16_t* background, int width,
+                                               int shift, int bin_Shift, uint32_t* banks){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m128i bin_Count = _mm_cvtsi32_si128(bin_Shift);
+            alignas(32) uint16_t bins[16];
+            int col = 0;
+            for(; col + 16 <= width; col += 16){
+                __m256i pixel = Load_16<Subtract>(pixels + col, Offset<Subtract>(background, col), count);
+                _mm256_store_si256((__m256i*)bins, _mm256_srl_epi16(pixel, bin_Count));
+                Count_8(bins, banks);
+                Count_8(bins + 8, banks);
+            }
+            _mm256_zeroupper();
+            Row_Histogram_Scalar<Subtract>(pixels + col, Offset<Subtract>(background, col), width - col,
+                                           shift, bin_Shift, banks);
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        LD_TARGET_AVX2 int Project_Row_AVX2(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                                            uint16_t thresh, uint32_t* col_Acc, uint32_t& row_Total){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m256i flip = _mm256_set1_epi16(sign_Bit);
+            const __m256i flipped_Thresh = _mm256_set1_epi16((short)(thresh ^ 0x8000));
+            __m256i row_Acc = _mm256_setzero_si256();
+            __m256i n_Acc = _mm256_setzero_si256();
+            int col = 0;
+            for(; col + 16 <= width; col += 16){
+                __m256i pixel = Load_16<Subtract>(pixels + col, Offset<Subtract>(background, col), count);
+                __m256i mask = _mm256_cmpgt_epi16(_mm256_xor_si256(pixel, flip), flipped_Thresh);
+                __m256i kept = _mm256_and_si256(pixel, mask);
+                // mask is -1 where the pixel counts.
+                n_Acc = _mm256_sub_epi16(n_Acc, mask);
+
+                // Widen to 32 bits, in order (the unpack instructions would
+                // shuffle the 128 bit halves)
+                __m256i kept_Lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(kept));
+                __m256i kept_Hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(kept, 1));
+                __m256i* col_Ptr = (__m256i*)(col_Acc + col);
+                _mm256_storeu_si256(col_Ptr, _mm256_add_epi32(_mm256_loadu_si256(col_Ptr), kept_Lo));
+                _mm256_storeu_si256(col_Ptr + 1, _mm256_add_epi32(_mm256_loadu_si256(col_Ptr + 1), kept_Hi));
+                row_Acc = _mm256_add_epi32(row_Acc, _mm256_add_epi32(kept_Lo, kept_Hi));
+            }
+            row_Total += Sum_Epi32(row_Acc);
+            int n_Pixels = Sum_Epi32(_mm256_madd_epi16(n_Acc, _mm256_set1_epi16(1)));
+            return n_Pixels + Project_Row_Scalar<Subtract>(pixels + col, Offset<Subtract>(background, col),
+                                                           width - col, shift, thresh, col_Acc + col, row_Total);
+        }
+
+        // As the SSE2 version, 16 columns at a time.
+        template <typename Pixel_T>
+        LD_TARGET_AVX2 void Box_Sum_Band_AVX2(const Pixel_T* first_Row, int stride, int shift, int factor,
+                                              int n_Blocks, uint32_t* sums){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m256i ones = _mm256_set1_epi16(1);
+            int blocks_Per_Load = 16 / factor;
+            int block = 0;
+            for(; block + blocks_Per_Load <= n_Blocks; block += blocks_Per_Load){
+                const Pixel_T* pixels = first_Row + (block * factor);
+                __m256i column_Sums = _mm256_setzero_si256();
+                for(int row=0; row < factor; row++){
+                    column_Sums = _mm256_add_epi16(column_Sums, Load_16(pixels, count));
+                    pixels += stride;
+                }
+                // Pairs of columns, then (hadd works within each 128 bit
+                // half) fours.
+                __m256i pair_Sums = _mm256_madd_epi16(column_Sums, ones);
+                __m256i quad_Sums = _mm256_hadd_epi32(pair_Sums, pair_Sums);
+                if (factor == 8){
+                    __m256i block_Sums = _mm256_hadd_epi32(quad_Sums, quad_Sums);
+                    sums[block] = _mm256_extract_epi32(block_Sums, 0);
+                    sums[block + 1] = _mm256_extract_epi32(block_Sums, 4);
+                }
+                else{
+                    // The 4 sums are the bottom 64 bits of each half.
+                    __m256i block_Sums = _mm256_permute4x64_epi64(quad_Sums, _MM_SHUFFLE(3, 1, 2, 0));
+                    _mm_storeu_si128((__m128i*)(sums + block), _mm256_castsi256_si128(block_Sums));
+                }
+            }
+            // The call below can become a jump that skips the vzeroupper
+            // the compiler would put on the way out, leaving every SSE
+            // instruction after it slow.
+            _mm256_zeroupper();
+            Box_Sum_Band_Scalar(first_Row + (block * factor), stride, shift, factor,
+                                n_Blocks - block, sums + block);
+        }
+
+        // As the SSE2 version, 16 pixels at a time. Each 128 bit half of
+        // the pixels widens to a whole register of averages, and packs
+        // works within 128 bit halves so the result needs putting back in
+        // order.
+        template <typename Pixel_T>
+        LD_TARGET_AVX2 void Average_Row_AVX2(const Pixel_T* pixels, int width, int shift, int fraction_Bits,
+                                             int rate_Shift, uint32_t* average, uint16_t* estimate){
+            const __m128i count = _mm_cvtsi32_si128(shift);
+            const __m128i fraction = _mm_cvtsi32_si128(fraction_Bits);
+            const __m128i rate = _mm_cvtsi32_si128(rate_Shift);
+            const __m256i half = _mm256_set1_epi32(1 << (fraction_Bits - 1));
+            const __m256i flip_32 = _mm256_set1_epi32(0x8000);
+            const __m256i flip_16 = _mm256_set1_epi16((short)0x8000);
+            int col = 0;
+            for(; col + 16 <= width; col += 16){
+                __m256i pixel = Load_16(pixels + col, count);
+                __m256i target_Lo = _mm256_sll_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(pixel)), fraction);
+                __m256i target_Hi = _mm256_sll_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(pixel, 1)), fraction);
+                __m256i average_Lo = _mm256_loadu_si256((const __m256i*)(average + col));
+                __m256i average_Hi = _mm256_loadu_si256((const __m256i*)(average + col + 8));
+                average_Lo = _mm256_add_epi32(average_Lo, _mm256_sra_epi32(_mm256_sub_epi32(target_Lo, average_Lo), rate));
+                average_Hi = _mm256_add_epi32(average_Hi, _mm256_sra_epi32(_mm256_sub_epi32(target_Hi, average_Hi), rate));
+                _mm256_storeu_si256((__m256i*)(average + col), average_Lo);
+                _mm256_storeu_si256((__m256i*)(average + col + 8), average_Hi);
+
+                __m256i estimate_Lo = _mm256_sub_epi32(_mm256_srl_epi32(_mm256_add_epi32(average_Lo, half), fraction),
+                                                       flip_32);
+                __m256i estimate_Hi = _mm256_sub_epi32(_mm256_srl_epi32(_mm256_add_epi32(average_Hi, half), fraction),
+                                                       flip_32);
+                __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(estimate_Lo, estimate_Hi),
+                                                          _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256((__m256i*)(estimate + col), _mm256_xor_si256(packed, flip_16));
+            }
+            Average_Row_Scalar(pixels + col, width - col, shift, fraction_Bits, rate_Shift,
+                               average + col, estimate + col);
+        }
+        // As the SSE2 version, 8 pixels at a time. The shifts only work
+        // within 128 bit halves, so the prefix sum has one more step to
+        // carry the bottom half's total into the top half.
+        LD_TARGET_AVX2 inline __m256i Prefix_Sum_Epi32(__m256i values){
+            values = _mm256_add_epi32(values, _mm256_slli_si256(values, 4));
+            values = _mm256_add_epi32(values, _mm256_slli_si256(values, 8));
+            __m256i bottom_Total = _mm256_permutevar8x32_epi32(values, _mm256_set1_epi32(3));
+            return _mm256_add_epi32(values, _mm256_blend_epi32(_mm256_setzero_si256(), bottom_Total, 0xF0));
+        }
+
+        LD_TARGET_AVX2 void Integral_Row_AVX2(const uint16_t* line, int width, uint16_t floor,
+                                              const uint32_t* above_I, uint32_t* sum_I){
+            const __m128i floor_16 = _mm_set1_epi16((short)floor);
+            __m256i carry_I = _mm256_setzero_si256();
+            int col = 0;
+            for(; col + 8 <= width; col += 8){
+                __m256i pixel = _mm256_cvtepu16_epi32(
+                    _mm_subs_epu16(_mm_loadu_si128((const __m128i*)(line + col)), floor_16));
+                __m256i total = _mm256_add_epi32(Prefix_Sum_Epi32(pixel), carry_I);
+                carry_I = _mm256_permutevar8x32_epi32(total, _mm256_set1_epi32(7));
+                _mm256_storeu_si256((__m256i*)(sum_I + col),
+                                    _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(above_I + col)), total));
+            }
+            uint32_t row_I = _mm256_cvtsi256_si32(carry_I);
+            Integral_Row_Scalar(line + col, width - col, floor, above_I + col, sum_I + col, row_I);
+        }
+        #endif // LD_SIMD_X86
+
+        // The fixed size blocks, for Fixed_Rows_Max and Fixed_Project_Rows.
+        // The row kernels get inlined with Width as a constant, so their
+        // loops unroll completely and there's no tail.
+        template <typename Pixel_T>
+        inline const Pixel_T* Fixed_Row(const uint8_t* rows, int stride, int row){
+            return (const Pixel_T*)(rows + (row * stride));
+        }
+
+        template <int Width, int Height, bool Subtract, bool Sum, typename Pixel_T>
+        LD_FLATTEN
+        uint16_t Fixed_Rows_Max_Scalar(const uint8_t* rows, int stride, const uint16_t* background,
+                                       int background_Stride, int shift, uint16_t* row_Max, Row_Sums* sums){
+            uint16_t max_Pixel = 0;
+            for(int row=0; row < Height; row++){
+                row_Max[row] = Row_Max_Scalar<Subtract, Sum>(Fixed_Row<Pixel_T>(rows, stride, row),
+                                                             Offset<Subtract>(background, row * background_Stride),
+                                                             Width, shift, Sum ? &sums[row] : nullptr);
+                max_Pixel = std::max(max_Pixel, row_Max[row]);
+            }
+            return max_Pixel;
+        }
+
+        template <int Width, int Height, bool Subtract, typename Pixel_T>
+        LD_FLATTEN
+        int Fixed_Project_Rows_Scalar(const uint8_t* rows, int stride, const uint16_t* background,
+                                      int background_Stride, int shift, uint16_t thresh,
+                                      const uint16_t* row_Max, uint64_t* row_Totals, uint32_t* col_Acc){
+            int n_Pixels = 0;
+            for(int row=0; row < Height; row++){
+                if (row_Max[row] > thresh){
+                    uint32_t row_Total = 0;
+                    n_Pixels += Project_Row_Scalar<Subtract>(Fixed_Row<Pixel_T>(rows, stride, row),
+                                                             Offset<Subtract>(background, row * background_Stride),
+                                                             Width, shift, thresh, col_Acc, row_Total);
+                    row_Totals[row] = row_Total;
+                }
+            }
+            return n_Pixels;
+        }
+
+        #if LD_SIMD_X86
+        template <int Width, int Height, bool Subtract, bool Sum, typename Pixel_T>
+        LD_FLATTEN
+        LD_TARGET_SSE2 uint16_t Fixed_Rows_Max_SSE2(const uint8_t* rows, int stride, const uint16_t* background,
+                                                    int background_Stride, int shift, uint16_t* row_Max,
+                                                    Row_Sums* sums){
+            uint16_t max_Pixel = 0;
+            for(int row=0; row < Height; row++){
+                row_Max[row] = Row_Max_SSE2<Subtract, Sum>(Fixed_Row<Pixel_T>(rows, stride, row),
+                                                           Offset<Subtract>(background, row * background_Stride),
+                                                           Width, shift, Sum ? &sums[row] : nullptr);
+                max_Pixel = std::max(max_Pixel, row_Max[row]);
+            }
+            return max_Pixel;
+        }
+
+        template <int Width, int Height, bool Subtract, typename Pixel_T>
+        LD_FLATTEN
+        LD_TARGET_SSE2 int Fixed_Project_Rows_SSE2(const uint8_t* rows, int stride, const uint16_t* background,
+                                                   int background_Stride, int shift, uint16_t thresh,
+                                                   const uint16_t* row_Max, uint64_t* row_Totals, uint32_t* col_Acc){
+            int n_Pixels = 0;
+            for(int row=0; row < Height; row++){
+                if (row_Max[row] > thresh){
+                    uint32_t row_Total = 0;
+                    n_Pixels += Project_Row_SSE2<Subtract>(Fixed_Row<Pixel_T>(rows, stride, row),
+                                                           Offset<Subtract>(background, row * background_Stride),
+                                                           Width, shift, thresh, col_Acc, row_Total);
+                    row_Totals[row] = row_Total;
+                }
+            }
+            return n_Pixels;
+        }
+
+        template <int Width, int Height, bool Subtract, bool Sum, typename Pixel_T>
+        LD_FLATTEN
+        LD_TARGET_AVX2 uint16_t Fixed_Rows_Max_AVX2(const uint8_t* rows, int stride, const uint16_t* background,
+                                                    int background_Stride, int shift, uint16_t* row_Max,
+                                                    Row_Sums* sums){
+            uint16_t max_Pixel = 0;
+            for(int row=0; row < Height; row++){
+                row_Max[row] = Row_Max_AVX2<Subtract, Sum>(Fixed_Row<Pixel_T>(rows, stride, row),
+                                                           Offset<Subtract>(background, row * background_Stride),
+                                                           Width, shift, Sum ? &sums[row] : nullptr);
+                max_Pixel = std::max(max_Pixel, row_Max[row]);
+            }
+            return max_Pixel;
+        }
+
+        template <int Width, int Height, bool Subtract, typename Pixel_T>
+        LD_FLATTEN
+        LD_TARGET_AVX2 int Fixed_Project_Rows_AVX2(const uint8_t* rows, int stride, const uint16_t* background,
+                                                   int background_Stride, int shift, uint16_t thresh,
+                                                   const uint16_t* row_Max, uint64_t* row_Totals, uint32_t* col_Acc){
+            int n_Pixels = 0;
+            for(int row=0; row < Height; row++){
+                if (row_Max[row] > thresh){
+                    uint32_t row_Total = 0;
+                    n_Pixels += Project_Row_AVX2<Subtract>(Fixed_Row<Pixel_T>(rows, stride, row),
+                                                           Offset<Subtract>(background, row * background_Stride),
+                                                           Width, shift, thresh, col_Acc, row_Total);
+                    row_Totals[row] = row_Total;
+                }
+            }
+            return n_Pixels;
+        }
+        #endif // LD_SIMD_X86
+
+        template <bool Subtract, bool Sum, typename Pixel_T>
+        uint16_t Row_Max_T(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                           Row_Sums* sums){
+            #if LD_SIMD_X86
+            // The SIMD sums are signed, so no good for full 16 bit pixels.
+            bool fits = !Sum || (Full_Scale<Pixel_T>(shift) < 0x8000);
+            switch (fits ? LD_Simd::Get_Simd_Level() : LD_Simd::SIMD_NONE){
+                case LD_Simd::SIMD_AVX2:
+                    return Row_Max_AVX2<Subtract, Sum>(pixels, background, width, shift, sums);
+                case LD_Simd::SIMD_SSE2:
+                    return Row_Max_SSE2<Subtract, Sum>(pixels, background, width, shift, sums);
+                case LD_Simd::SIMD_NONE:
+                    break;
+            }
+            #endif // LD_SIMD_X86
+            return Row_Max_Scalar<Subtract, Sum>(pixels, background, width, shift, sums);
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        void Row_Histogram_T(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                             int bin_Shift, uint32_t* banks){
+            #if LD_SIMD_X86
+            switch (LD_Simd::Get_Simd_Level()){
+                case LD_Simd::SIMD_AVX2:
+                    return Row_Histogram_AVX2<Subtract>(pixels, background, width, shift, bin_Shift, banks);
+                case LD_Simd::SIMD_SSE2:
+                    return Row_Histogram_SSE2<Subtract>(pixels, background, width, shift, bin_Shift, banks);
+                case LD_Simd::SIMD_NONE:
+                    break;
+            }
+            #endif // LD_SIMD_X86
+            return Row_Histogram_Scalar<Subtract>(pixels, background, width, shift, bin_Shift, banks);
+        }
+
+        template <bool Subtract, typename Pixel_T>
+        int Project_Row_T(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                          uint16_t thresh, uint32_t* col_Acc, uint32_t& row_Total){
+            #if LD_SIMD_X86
+            switch (LD_Simd::Get_Simd_Level()){
+                case LD_Simd::SIMD_AVX2:
+                    return Project_Row_AVX2<Subtract>(pixels, background, width, shift, thresh, col_Acc, row_Total);
+                case LD_Simd::SIMD_SSE2:
+                    return Project_Row_SSE2<Subtract>(pixels, background, width, shift, thresh, col_Acc, row_Total);
+                case LD_Simd::SIMD_NONE:
+                    break;
+            }
+            #endif // LD_SIMD_X86
+            return Project_Row_Scalar<Subtract>(pixels, background, width, shift, thresh, col_Acc, row_Total);
+        }
+
+        // Pick the right version for the pixel size, whether there's a
+        // background and whether the sums are wanted.
+        template <bool Subtract, typename Pixel_T>
+        uint16_t Row_Max_S(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                           Row_Sums* sums){
+            if (sums){
+                return Row_Max_T<Subtract, true>(pixels, background, width, shift, sums);
+            }
+            else{
+                return Row_Max_T<Subtract, false>(pixels, background, width, shift, sums);
+            }
+        }
+
+        template <typename Pixel_T>
+        uint16_t Row_Max_B(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                           Row_Sums* sums){
+            if (background){
+                return Row_Max_S<true>(pixels, background, width, shift, sums);
+            }
+            else{
+                return Row_Max_S<false>(pixels, background, width, shift, sums);
+            }
+        }
+
+        template <typename Pixel_T>
+        void Row_Histogram_B(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                             int bin_Shift, uint32_t* banks){
+            if (background){
+                return Row_Histogram_T<true>(pixels, background, width, shift, bin_Shift, banks);
+            }
+            else{
+                return Row_Histogram_T<false>(pixels, background, width, shift, bin_Shift, banks);
+            }
+        }
+
+        template <typename Pixel_T>
+        int Project_Row_B(const Pixel_T* pixels, const uint16_t* background, int width, int shift,
+                          uint16_t thresh, uint32_t* col_Acc, uint32_t& row_Total){
+            if (background){
+                return Project_Row_T<true>(pixels, background, width, shift, thresh, col_Acc, row_Total);
+            }
+            else{
+                return Project_Row_T<false>(pixels, background, width, shift, thresh, col_Acc, row_Total);
+            }
+        }
+
+        template <int Width, int Height, bool Subtract, bool Sum, typename Pixel_T>
+        uint16_t Fixed_Rows_Max_T(const uint8_t* rows, int stride, const uint16_t* background,
+                                  int background_Stride, int shift, uint16_t* row_Max, Row_Sums* sums){
+            #if LD_SIMD_X86
+            bool fits = Full_Scale<Pixel_T>(shift) < 0x8000;
+            switch (fits ? LD_Simd::Get_Simd_Level() : LD_Simd::SIMD_NONE){
+                case LD_Simd::SIMD_AVX2:
+                    return Fixed_Rows_Max_AVX2<Width, Height, Subtract, Sum, Pixel_T>(rows, stride, background,
+                                                                                      background_Stride, shift,
+                                                                                      row_Max, sums);
+                case LD_Simd::SIMD_SSE2:
+                    return Fixed_Rows_Max_SSE2<Width, Height, Subtract, Sum, Pixel_T>(rows, stride, background,
+                                                                                      background_Stride, shift,
+                                                                                      row_Max, sums);
+                case LD_Simd::SIMD_NONE:
+                    break;
+            }
+            #endif // LD_SIMD_X86
+            return Fixed_Rows_Max_Scalar<Width, Height, Subtract, Sum, Pixel_T>(rows, stride, background,
+                                                                                background_Stride, shift,
+                                                                                row_Max, sums);
+        }
+
+        template <int Width, int Height, bool Subtract, typename Pixel_T>
+        int Fixed_Project_Rows_T(const uint8_t* rows, int stride, const uint16_t* background,
+                                 int background_Stride, int shift, uint16_t thresh,
+                                 const uint16_t* row_Max, uint64_t* row_Totals, uint32_t* col_Acc){
+            #if LD_SIMD_X86
+            switch (LD_Simd::Get_Simd_Level()){
+                case LD_Simd::SIMD_AVX2:
+                    return Fixed_Project_Rows_AVX2<Width, Height, Subtract, Pixel_T>(rows, stride, background,
+                                                                                     background_Stride, shift, thresh,
+                                                                                     row_Max, row_Totals, col_Acc);
+                case LD_Simd::SIMD_SSE2:
+                    return Fixed_Project_Rows_SSE2<Width, Height, Subtract, Pixel_T>(rows, stride, background,
+                                                                                     background_Stride, shift, thresh,
+                                                                                     row_Max, row_Totals, col_Acc);
+                case LD_Simd::SIMD_NONE:
+                    break;
+            }
+            #endif // LD_SIMD_X86
+            return Fixed_Project_Rows_Scalar<Width, Height, Subtract, Pixel_T>(rows, stride, background,
+                                                                               background_Stride, shift, thresh,
+                                                                               row_Max, row_Totals, col_Acc);
+        }
+
+        template <int Width, int Height, bool Subtract, typename Pixel_T>
+        uint16_t Fixed_Rows_Max_S(const uint8_t* rows, int stride, const uint16_t* background,
+                                  int background_Stride, int shift, uint16_t* row_Max, Row_Sums* sums){
+            if (sums){
+                return Fixed_Rows_Max_T<Width, Height, Subtract, true, Pixel_T>(rows, stride, background,
+                                                                                background_Stride, shift,
+                                                                                row_Max, sums);
+            }
+            else{
+                return Fixed_Rows_Max_T<Width, Height, Subtract, false, Pixel_T>(rows, stride, background,
+                                                                                 background_Stride, shift,
+                                                                                 row_Max, sums);
+            }
+        }
+
+        template <int Width, int Height, typename Pixel_T>
+        uint16_t Fixed_Rows_Max_B(const uint8_t* rows, int stride, const uint16_t* background,
+                                  int background_Stride, int shift, uint16_t* row_Max, Row_Sums* sums){
+            if (background){
+                return Fixed_Rows_Max_S<Width, Height, true, Pixel_T>(rows, stride, background, background_Stride,
+                                                                      shift, row_Max, sums);
+            }
+            else{
+                return Fixed_Rows_Max_S<Width, Height, false, Pixel_T>(rows, stride, background, background_Stride,
+                                                                       shift, row_Max, sums);
+            }
+        }
+
+        template <int Width, int Height, typename Pixel_T>
+        int Fixed_Project_Rows_B(const uint8_t* rows, int stride, const uint16_t* background,
+                                 int background_Stride, int shift, uint16_t thresh,
+                                 const uint16_t* row_Max, uint64_t* row_Totals, uint32_t* col_Acc){
+            if (background){
+                return Fixed_Project_Rows_T<Width, Height, true, Pixel_T>(rows, stride, background,
+                                                                          background_Stride, shift, thresh,
+                                                                          row_Max, row_Totals, col_Acc);
+            }
+            else{
+                return Fixed_Project_Rows_T<Width, Height, false, Pixel_T>(rows, stride, background,
+                                                                           background_Stride, shift, thresh,
+                                                                           row_Max, row_Totals, col_Acc);
+            }
+        }
+
+        template <typename Pixel_T>
+        void Box_Sum_Band_T(const Pixel_T* first_Row, int stride, int shift, int factor,
+                            int n_Blocks, uint32_t* sums){
+            #if LD_SIMD_X86
+            if ((factor == 4) || (factor == 8)){
+                switch (LD_Simd::Get_Simd_Level()){
+                    case LD_Simd::SIMD_AVX2:
+                        return Box_Sum_Band_AVX2(first_Row, stride, shift, factor, n_Blocks, sums);
+                    case LD_Simd::SIMD_SSE2:
+                        return Box_Sum_Band_SSE2(first_Row, stride, shift, factor, n_Blocks, sums);
+                    case LD_Simd::SIMD_NONE:
+                        break;
+                }
+            }
+            #endif // LD_SIMD_X86
+            return Box_Sum_Band_Scalar(first_Row, stride, shift, factor, n_Blocks, sums);
+        }
+
+        template <typename Pixel_T>
+        void Average_Row_T(const Pixel_T* pixels, int width, int shift, int fraction_Bits, int rate_Shift,
+                           uint32_t* average, uint16_t* estimate){
+            #if LD_SIMD_X86
+            switch (LD_Simd::Get_Simd_Level()){
+                case LD_Simd::SIMD_AVX2:
+                    return Average_Row_AVX2(pixels, width, shift, fraction_Bits, rate_Shift, average, estimate);
+                case LD_Simd::SIMD_SSE2:
+                    return Average_Row_SSE2(pixels, width, shift, fraction_Bits, rate_Shift, average, estimate);
+                case LD_Simd::SIMD_NONE:
+                    break;
+            }
+            #endif // LD_SIMD_X86
+            return Average_Row_Scalar(pixels, width, shift, fraction_Bits, rate_Shift, average, estimate);
+        }
+    } // namespace
+
+    uint16_t Row_Max(const uint8_t* row, int width, int bits_Per_Pixel, const uint16_t* background,
+                     Row_Sums* sums){
+        if (bits_Per_Pixel > 8){
+            return Row_Max_B((const uint16_t*)row, background, width, 16 - bits_Per_Pixel, sums);
+        }
+        else{
+            return Row_Max_B(row, background, width, 0, sums);
+        }
+    }
+
+    template <int Width, int Height>
+    uint16_t Fixed_Rows_Max(const uint8_t* rows, int stride, int bits_Per_Pixel,
+                            const uint16_t* background, int background_Stride,
+                            uint16_t* row_Max, Row_Sums* sums){
+        if (bits_Per_Pixel > 8){
+            return Fixed_Rows_Max_B<Width, Height, uint16_t>(rows, stride, background, background_Stride,
+                                                             16 - bits_Per_Pixel, row_Max, sums);
+        }
+        else{
+            return Fixed_Rows_Max_B<Width, Height, uint8_t>(rows, stride, background, background_Stride,
+                                                            0, row_Max, sums);
+        }
+    }
+
+    template <int Width, int Height>
+    int Fixed_Project_Rows(const uint8_t* rows, int stride, int bits_Per_Pixel,
+                           const uint16_t* background, int background_Stride, uint16_t thresh,
+                           const uint16_t* row_Max, uint64_t* row_Totals, uint32_t* col_Acc){
+        if (bits_Per_Pixel > 8){
+            return Fixed_Project_Rows_B<Width, Height, uint16_t>(rows, stride, background, background_Stride,
+                                                                 16 - bits_Per_Pixel, thresh,
+                                                                 row_Max, row_Totals, col_Acc);
+        }
+        else{
+            return Fixed_Project_Rows_B<Width, Height, uint8_t>(rows, stride, background, background_Stride,
+                                                                0, thresh, row_Max, row_Totals, col_Acc);
+        }
+    }
+
+    // The AOI sizes.
+    template uint16_t Fixed_Rows_Max<128, 128>(const uint8_t*, int, int, const uint16_t*, int, uint16_t*, Row_Sums*);
+    template uint16_t Fixed_Rows_Max<256, 256>(const uint8_t*, int, int, const uint16_t*, int, uint16_t*, Row_Sums*);
+    template int Fixed_Project_Rows<128, 128>(const uint8_t*, int, int, const uint16_t*, int, uint16_t,
+                                              const uint16_t*, uint64_t*, uint32_t*);
+    template int Fixed_Project_Rows<256, 256>(const uint8_t*, int, int, const uint16_t*, int, uint16_t,
+                                              const uint16_t*, uint64_t*, uint32_t*);
+
+    void Row_Histogram(const uint8_t* row, int width, int bits_Per_Pixel, int bin_Shift,
+                       uint32_t* banks, const uint16_t* background){
+        if (bits_Per_Pixel > 8){
+            Row_Histogram_B((const uint16_t*)row, background, width, 16 - bits_Per_Pixel, bin_Shift, banks);
+        }
+        else{
+            Row_Histogram_B(row, background, width, 0, bin_Shift, banks);
+        }
+    }
+
+    int Project_Row(const uint8_t* row, int width, int bits_Per_Pixel, uint16_t thresh,
+                    uint32_t* col_Acc, uint32_t& row_Total, const uint16_t* background){
+        if (bits_Per_Pixel > 8){
+            return Project_Row_B((const uint16_t*)row, background, width, 16 - bits_Per_Pixel, thresh,
+                                 col_Acc, row_Total);
+        }
+        else{
+            return Project_Row_B(row, background, width, 0, thresh, col_Acc, row_Total);
+        }
+    }
+
+    void Box_Sum_Band(const uint8_t* first_Row, int stride, int bits_Per_Pixel, int factor,
+                      int n_Blocks, uint32_t* sums){
+        if (bits_Per_Pixel > 8){
+            Box_Sum_Band_T((const uint16_t*)first_Row, stride / 2, 16 - bits_Per_Pixel, factor,
+                           n_Blocks, sums);
+        }
+        else{
+            Box_Sum_Band_T(first_Row, stride, 0, factor, n_Blocks, sums);
+        }
+    }
+
+    void Average_Row(const uint8_t* row, int width, int bits_Per_Pixel, int fraction_Bits, int rate_Shift,
+                     uint32_t* average, uint16_t* estimate){
+        if (bits_Per_Pixel > 8){
+            Average_Row_T((const uint16_t*)row, width, 16 - bits_Per_Pixel, fraction_Bits, rate_Shift,
+                          average, estimate);
+        }
+        else{
+            Average_Row_T(row, width, 0, fraction_Bits, rate_Shift, average, estimate);
+        }
+    }
+
+    void Integral_Row(const uint16_t* line, int width, uint16_t floor, const uint32_t* above_I, uint32_t* sum_I){
+        #if LD_SIMD_X86
+        switch (LD_Simd::Get_Simd_Level()){
+            case LD_Simd::SIMD_AVX2:
+                return Integral_Row_AVX2(line, width, floor, above_I, sum_I);
+            case LD_Simd::SIMD_SSE2:
+                return Integral_Row_SSE2(line, width, floor, above_I, sum_I);
+            case LD_Simd::SIMD_NONE:
+                break;
+        }
+        #endif // LD_SIMD_X86
+        uint32_t row_I = 0;
+        Integral_Row_Scalar(line, width, floor, above_I, sum_I, row_I);
+    }
+
+} // namespace LD_QuarcTracker
@@ -0,0 +1,57 @@
+#include "LD_Simd.h"
+
+#include <atomic>
+
+namespace LD_Simd{
+    namespace{
+        // -1 means "not decided yet", work it out on first use. Atomic since
+        // any thread might be the first to ask.
+        std::atomic<int> active_Level(-1);
+    } // namespace
+
+    Simd_Level Cpu_Simd_Level(){
+        #if LD_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")){
+            return SIMD_AVX2;
+        }
+        if (__builtin_cpu_supports("sse2")){
+            return SIMD_SSE2;
+        }
+        #endif // LD_SIMD_X86
+        return SIMD_NONE;
+    }
+
+    Simd_Level Get_Simd_Level(){
+        int level = active_Level.load(std::memory_order_relaxed);
+        if (level < 0){
+            // Every thread works out the same answer, so it doesn't matter
+            // which one stores it.
+            level = Cpu_Simd_Level();
+            int not_Decided = -1;
+            active_Level.compare_exchange_strong(not_Decided, level, std::memory_order_relaxed);
+            level = active_Level.load(std::memory_order_relaxed);
+        }
+        return (Simd_Level)level;
+    }
+
+    Simd_Level Set_Simd_Level(Simd_Level new_Level){
+        Simd_Level cpu_Level = Cpu_Simd_Level();
+        Simd_Level level = (new_Level > cpu_Level) ? cpu_Level : new_Level;
+        active_Level.store(level, std::memory_order_relaxed);
+        return level;
+    }
+
+    std::string Simd_Level_Name(Simd_Level level){
+        switch (level){
+            case SIMD_AVX2:
+                return "avx2";
+            case SIMD_SSE2:
+                return "sse2";
+            case SIMD_NONE:
+                break;
+        }
+        return "scalar";
+    }
+
+} // namespace LD_Simd
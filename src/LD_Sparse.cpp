@@ -0,0 +1,131 @@
+#include "LD_Sparse.h"
+#include "LD_RowKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace LD_QuarcTracker{
+    int Sparse_Stride(int spot_Size){
+        return std::max((int)(spot_Size / std::sqrt(2.0)), 1);
+    }
+
+    int Sample_Grid(const LD_Camera::Frame_View& my_Frame, int stride,
+                    const Pixel_Corrections& corrections, Sparse_Grid& grid){
+        if (stride < 1){
+            std::cout << "Sparse stride " << stride << " not supported" << "\n";
+            return 1;
+        }
+        grid.stride = stride;
+        grid.first = stride / 2;
+        grid.width = 0;
+        grid.height = 0;
+        grid.bytes_Read = 0;
+        if (!my_Frame.Valid()){
+            grid.samples.clear();
+            grid.row_Max.clear();
+            return 0;
+        }
+        grid.width = (my_Frame.width - grid.first + stride - 1) / stride;
+        grid.height = (my_Frame.height - grid.first + stride - 1) / stride;
+        grid.samples.resize(grid.width * grid.height);
+        grid.row_Max.resize(grid.height);
+
+        int bytes_Per_Pixel = my_Frame.Bytes_Per_Pixel();
+        int shift = my_Frame.Shift();
+        // Samples further apart than a cache line each cost a line, closer
+        // and the whole row gets read anyway.
+        uint64_t row_Bytes = (uint64_t)my_Frame.width * bytes_Per_Pixel;
+        if (stride * bytes_Per_Pixel >= cache_Line_Bytes){
+            row_Bytes = (uint64_t)grid.width * cache_Line_Bytes;
+        }
+
+        int first = grid.first;
+        int n_Cols = grid.width;
+        for(int grid_Row=0; grid_Row < grid.height; grid_Row++){
+            int row = first + (grid_Row * stride);
+            const uint8_t* pixels = my_Frame.Row(row);
+            uint16_t* samples = grid.samples.data() + (grid_Row * n_Cols);
+            if (bytes_Per_Pixel > 1){
+                const uint8_t* pixel = pixels + (2 * first);
+                for(int grid_Col=0; grid_Col < n_Cols; grid_Col++){
+                    samples[grid_Col] = (pixel[0] + (pixel[1] << 8)) >> shift;
+                    pixel += 2 * stride;
+                }
+            }
+            else{
+                const uint8_t* pixel = pixels + first;
+                for(int grid_Col=0; grid_Col < n_Cols; grid_Col++){
+                    samples[grid_Col] = *pixel;
+                    pixel += stride;
+                }
+            }
+            grid.bytes_Read += row_Bytes;
+
+            // Corrections after, so the loops above stay simple.
+            Row_Corrections row_Corrections = Corrections_For_Row(corrections, my_Frame, row);
+            if (row_Corrections.subtract){
+                const uint16_t* subtract = row_Corrections.subtract + first;
+                for(int grid_Col=0; grid_Col < n_Cols; grid_Col++){
+                    uint16_t value = samples[grid_Col];
+                    samples[grid_Col] = (value > *subtract) ? (value - *subtract) : 0;
+                    subtract += stride;
+                }
+            }
+            const LD_Camera::Bad_Columns& bad = row_Corrections.bad;
+            for(const uint16_t* bad_Col=bad.first; bad_Col != bad.last; bad_Col++){
+                int col = *bad_Col - bad.offset - first;
+                if ((col >= 0) && (col % stride == 0) && (col / stride < n_Cols)){
+                    samples[col / stride] = 0;
+                }
+            }
+            // The samples are laid out like a 16 bit row of a frame.
+            grid.row_Max[grid_Row] = Row_Max((const uint8_t*)samples, n_Cols, 16);
+        }
+        return 0;
+    }
+
+    bool Candidate_Box(const Sparse_Grid& grid, double peak_Thresh, uint16_t abs_Thresh,
+                       int& x, int& y, int& width, int& height){
+        if (grid.samples.empty()){
+            return false;
+        }
+        uint16_t max_Sample = *std::max_element(grid.row_Max.begin(), grid.row_Max.end());
+        uint16_t thresh = std::max((uint16_t)(max_Sample * peak_Thresh), abs_Thresh);
+
+        int min_Col = grid.width;
+        int max_Col = -1;
+        int min_Row = grid.height;
+        int max_Row = -1;
+        for(int grid_Row=0; grid_Row < grid.height; grid_Row++){
+            // Nearly every row has nothing over.
+            if (grid.row_Max[grid_Row] <= thresh){
+                continue;
+            }
+            const uint16_t* samples = grid.samples.data() + (grid_Row * grid.width);
+            int left = 0;
+            while (samples[left] <= thresh){
+                left++;
+            }
+            int right = grid.width - 1;
+            while (samples[right] <= thresh){
+                right--;
+            }
+            min_Col = std::min(min_Col, left);
+            max_Col = std::max(max_Col, right);
+            min_Row = std::min(min_Row, grid_Row);
+            max_Row = grid_Row;
+        }
+        if (max_Row < 0){
+            return false;
+        }
+        // Frame_View::Sub_View clips it to the frame.
+        int padding = 2 * grid.stride;
+        x = grid.first + (min_Col * grid.stride) - padding;
+        y = grid.first + (min_Row * grid.stride) - padding;
+        width = (max_Col - min_Col) * grid.stride + (2 * padding) + 1;
+        height = (max_Row - min_Row) * grid.stride + (2 * padding) + 1;
+        return true;
+    }
+
+} // namespace LD_QuarcTracker
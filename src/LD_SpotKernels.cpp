@@ -0,0 +1,533 @@
+#include "LD_SpotKernels.h"
+#include "LD_PixelKernels.h"
+#include "LD_RowKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace LD_QuarcTracker{
+    namespace{
+        // Make sure the containers are the right size and set to zeros.
+        void Reset_Totals(const LD_Camera::Frame_View& my_Frame,
+                          std::vector<uint64_t>& row_Totals,
+                          std::vector<uint64_t>& col_Totals){
+            if (row_Totals.size() != (unsigned int)my_Frame.height){
+                row_Totals.resize(my_Frame.height);
+            }
+            std::fill(row_Totals.begin(), row_Totals.end(), 0);
+            if (col_Totals.size() != (unsigned int)my_Frame.width){
+                col_Totals.resize(my_Frame.width);
+            }
+            std::fill(col_Totals.begin(), col_Totals.end(), 0);
+        }
+
+        const uint16_t* Offset(const uint16_t* subtract, int col){
+            return subtract ? (subtract + col) : nullptr;
+        }
+
+        // A corrected pixel value, without the SIMD.
+        uint16_t Corrected_Pixel(const LD_Camera::Frame_View& my_Frame, int row, int col,
+                                 const uint16_t* subtract){
+            uint16_t pixel = my_Frame.Pixel(col, row);
+            if (subtract){
+                pixel = (pixel > subtract[col]) ? (pixel - subtract[col]) : 0;
+            }
+            return pixel;
+        }
+
+        // What to use instead of the bad pixel at bad_Col (an entry in
+        // row_Corrections.bad), the average of the neighbours either side
+        // which are in the frame and aren't bad themselves.
+        uint16_t Replacement(const LD_Camera::Frame_View& my_Frame, int row,
+                             const Row_Corrections& row_Corrections, const uint16_t* bad_Col){
+            const LD_Camera::Bad_Columns& bad = row_Corrections.bad;
+            int col = *bad_Col - bad.offset;
+            bool left_Ok = (col > 0) && !((bad_Col != bad.first) && (*(bad_Col - 1) == *bad_Col - 1));
+            bool right_Ok = (col < my_Frame.width - 1) && !((bad_Col + 1 != bad.last) && (*(bad_Col + 1) == *bad_Col + 1));
+            uint32_t total = 0;
+            if (left_Ok){
+                total += Corrected_Pixel(my_Frame, row, col - 1, row_Corrections.subtract);
+            }
+            if (right_Ok){
+                total += Corrected_Pixel(my_Frame, row, col + 1, row_Corrections.subtract);
+            }
+            int n = left_Ok + right_Ok;
+            return (n > 0) ? (total / n) : 0;
+        }
+
+        // Project_Row on the corrected row, in pieces round the bad pixels
+        // if there are any.
+        int Corrected_Project_Row(const LD_Camera::Frame_View& my_Frame, int row,
+                                  const Row_Corrections& row_Corrections, uint16_t thresh,
+                                  uint32_t* col_Acc, uint32_t& row_Total){
+            const uint8_t* pixels = my_Frame.Row(row);
+            const uint16_t* subtract = row_Corrections.subtract;
+            if (row_Corrections.bad.Empty()){
+                return Project_Row(pixels, my_Frame.width, my_Frame.bits_Per_Pixel, thresh,
+                                   col_Acc, row_Total, subtract);
+            }
+            int bytes_Per_Pixel = my_Frame.Bytes_Per_Pixel();
+            int n_Peak_Pixels = 0;
+            int start = 0;
+            for(const uint16_t* bad_Col=row_Corrections.bad.first; bad_Col != row_Corrections.bad.last; bad_Col++){
+                int col = *bad_Col - row_Corrections.bad.offset;
+                n_Peak_Pixels += Project_Row(pixels + (start * bytes_Per_Pixel), col - start, my_Frame.bits_Per_Pixel,
+                                             thresh, col_Acc + start, row_Total, Offset(subtract, start));
+                uint16_t pixel = Replacement(my_Frame, row, row_Corrections, bad_Col);
+                if (pixel > thresh){
+                    col_Acc[col] += pixel;
+                    row_Total += pixel;
+                    n_Peak_Pixels++;
+                }
+                start = col + 1;
+            }
+            n_Peak_Pixels += Project_Row(pixels + (start * bytes_Per_Pixel), my_Frame.width - start,
+                                         my_Frame.bits_Per_Pixel, thresh, col_Acc + start, row_Total,
+                                         Offset(subtract, start));
+            return n_Peak_Pixels;
+        }
+
+        // Zero the sums of each row, ready for Corrected_Row_Max. Left
+        // empty if the metrics aren't wanted, so nothing's summed.
+        void Reset_Row_Sums(const LD_Camera::Frame_View& my_Frame, bool metrics, std::vector<Row_Sums>& row_Sums){
+            Row_Sums zero = {0, 0, 0};
+            row_Sums.assign(metrics ? my_Frame.height : 0, zero);
+        }
+
+        // Where to sum row, nullptr if row_Sums was left empty.
+        Row_Sums* Sums_For_Row(std::vector<Row_Sums>& row_Sums, int row){
+            return row_Sums.empty() ? nullptr : &row_Sums[row];
+        }
+
+        // Project rows first_Row up to (not including) last_Row, skipping
+        // any whose maximum (from row_Max) isn't over thresh. Return how
+        // many pixels counted.
+        int Project_Bright_Rows(const LD_Camera::Frame_View& my_Frame, const std::vector<uint16_t>& row_Max,
+                                uint16_t thresh, int first_Row, int last_Row,
+                                std::vector<uint64_t>& row_Totals, std::vector<uint32_t>& col_Acc,
+                                const Pixel_Corrections& corrections){
+            int n_Peak_Pixels = 0;
+            for(int row=first_Row; row < last_Row; row++){
+                if (row_Max[row] > thresh){
+                    uint32_t row_Total = 0;
+                    n_Peak_Pixels += Corrected_Project_Row(my_Frame, row,
+                                                           Corrections_For_Row(corrections, my_Frame, row),
+                                                           thresh, col_Acc.data(), row_Total);
+                    row_Totals[row] = row_Total;
+                }
+            }
+            return n_Peak_Pixels;
+        }
+
+        // The single pass version of the above. Rows are thresholded
+        // against the guess while they're still in cache from finding
+        // their maximum, so each row only comes from memory once.
+        int Project_Predicted_Rows(const LD_Camera::Frame_View& my_Frame, std::vector<uint16_t>& row_Max,
+                                   std::vector<Row_Sums>& row_Sums,
+                                   uint16_t thresh, int first_Row, int last_Row, uint16_t& max_Pixel,
+                                   std::vector<uint64_t>& row_Totals, std::vector<uint32_t>& col_Acc,
+                                   const Pixel_Corrections& corrections){
+            int n_Peak_Pixels = 0;
+            for(int row=first_Row; row < last_Row; row++){
+                Row_Corrections row_Corrections = Corrections_For_Row(corrections, my_Frame, row);
+                row_Max[row] = Corrected_Row_Max(my_Frame, row, row_Corrections, Sums_For_Row(row_Sums, row));
+                max_Pixel = std::max(max_Pixel, row_Max[row]);
+                if (row_Max[row] > thresh){
+                    uint32_t row_Total = 0;
+                    n_Peak_Pixels += Corrected_Project_Row(my_Frame, row, row_Corrections,
+                                                           thresh, col_Acc.data(), row_Total);
+                    row_Totals[row] = row_Total;
+                }
+            }
+            return n_Peak_Pixels;
+        }
+
+        // The corrections for the whole frame as one line to subtract and
+        // how far apart (in pixels) it is from one row to the next, which is
+        // what the Fixed_ row kernels take. False if they can't be put like
+        // that, or there are bad pixels to replace.
+        bool Uniform_Corrections(const LD_Camera::Frame_View& my_Frame, const Pixel_Corrections& corrections,
+                                 const uint16_t*& subtract, int& subtract_Stride){
+            subtract = Corrections_For_Row(corrections, my_Frame, 0).subtract;
+            subtract_Stride = 0;
+            if (subtract && (my_Frame.height > 1)){
+                subtract_Stride = Corrections_For_Row(corrections, my_Frame, 1).subtract - subtract;
+                int last_Row = my_Frame.height - 1;
+                if (Corrections_For_Row(corrections, my_Frame, last_Row).subtract !=
+                    subtract + (last_Row * subtract_Stride)){
+                    return false;
+                }
+            }
+            if (corrections.pixel_Map){
+                for(int row=0; row < my_Frame.height; row++){
+                    if (!corrections.pixel_Map->Bad_In_Row(my_Frame, row).Empty()){
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        template <int Width, int Height>
+        Projection_Stats Project_Fixed_T(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                                         std::vector<uint64_t>& row_Totals,
+                                         std::vector<uint64_t>& col_Totals,
+                                         Projection_Scratch& scratch,
+                                         const uint16_t* subtract, int subtract_Stride){
+            Projection_Stats stats = {0, 0, 0, false, 0, 0, 0, 0};
+            scratch.row_Max.resize(Height);
+            Reset_Row_Sums(my_Frame, scratch.metrics, scratch.row_Sums);
+            stats.max_Pixel = Fixed_Rows_Max<Width, Height>(my_Frame.data, my_Frame.stride, my_Frame.bits_Per_Pixel,
+                                                            subtract, subtract_Stride, scratch.row_Max.data(),
+                                                            Sums_For_Row(scratch.row_Sums, 0));
+            uint16_t thresh = Pick_Threshold(nullptr, peak_Thresh, Adaptive_Thresh(), stats);
+            Background_Stats(my_Frame, scratch.row_Max, scratch.row_Sums, thresh, stats);
+            scratch.col_Acc.assign(Width, 0);
+            stats.n_Peak_Pixels = Fixed_Project_Rows<Width, Height>(my_Frame.data, my_Frame.stride,
+                                                                    my_Frame.bits_Per_Pixel, subtract, subtract_Stride,
+                                                                    thresh, scratch.row_Max.data(), row_Totals.data(),
+                                                                    scratch.col_Acc.data());
+            std::copy(scratch.col_Acc.begin(), scratch.col_Acc.end(), col_Totals.begin());
+            return stats;
+        }
+
+        // Was the guess at the maximum too far off to trust the threshold
+        // that came from it?
+        bool Prediction_Failed(uint16_t max_Pixel, uint16_t predicted_Max, double rescan_Fraction){
+            if (predicted_Max == 0){
+                return true;
+            }
+            int difference = std::abs((int)max_Pixel - (int)predicted_Max);
+            return difference > (rescan_Fraction * predicted_Max);
+        }
+    } // namespace
+
+    Row_Corrections Corrections_For_Row(const Pixel_Corrections& corrections,
+                                        const LD_Camera::Frame_View& my_Frame, int row){
+        Row_Corrections row_Corrections = {nullptr, {nullptr, nullptr, 0}};
+        if (corrections.background){
+            row_Corrections.subtract = corrections.background->Row(my_Frame, row);
+        }
+        if (corrections.pixel_Map){
+            // The background has learned the column offsets already.
+            if (!row_Corrections.subtract){
+                row_Corrections.subtract = corrections.pixel_Map->Column_Offsets(my_Frame);
+            }
+            row_Corrections.bad = corrections.pixel_Map->Bad_In_Row(my_Frame, row);
+        }
+        return row_Corrections;
+    }
+
+    uint16_t Corrected_Row_Max(const LD_Camera::Frame_View& my_Frame, int row,
+                               const Row_Corrections& row_Corrections, Row_Sums* sums,
+                               Pixel_Histogram* histogram){
+        const uint8_t* pixels = my_Frame.Row(row);
+        const uint16_t* subtract = row_Corrections.subtract;
+        if (row_Corrections.bad.Empty()){
+            if (histogram){
+                Row_Histogram(pixels, my_Frame.width, my_Frame.bits_Per_Pixel, histogram->bin_Shift,
+                              histogram->banks.data(), subtract);
+            }
+            return Row_Max(pixels, my_Frame.width, my_Frame.bits_Per_Pixel, subtract, sums);
+        }
+        int bytes_Per_Pixel = my_Frame.Bytes_Per_Pixel();
+        uint16_t row_Max = 0;
+        int start = 0;
+        // Each piece between the bad pixels, then the rest of the row.
+        auto piece = [&](int end){
+            const uint8_t* first = pixels + (start * bytes_Per_Pixel);
+            if (histogram){
+                Row_Histogram(first, end - start, my_Frame.bits_Per_Pixel, histogram->bin_Shift,
+                              histogram->banks.data(), Offset(subtract, start));
+            }
+            row_Max = std::max(row_Max, Row_Max(first, end - start, my_Frame.bits_Per_Pixel,
+                                                Offset(subtract, start), sums));
+        };
+        for(const uint16_t* bad_Col=row_Corrections.bad.first; bad_Col != row_Corrections.bad.last; bad_Col++){
+            int col = *bad_Col - row_Corrections.bad.offset;
+            piece(col);
+            uint16_t pixel = Replacement(my_Frame, row, row_Corrections, bad_Col);
+            row_Max = std::max(row_Max, pixel);
+            // A stuck pixel being saturated says nothing about the spot.
+            if (sums){
+                sums->total += pixel;
+                sums->total_Squares += (uint32_t)pixel * pixel;
+            }
+            if (histogram){
+                Add_Pixel(*histogram, pixel);
+            }
+            start = col + 1;
+        }
+        piece(my_Frame.width);
+        return row_Max;
+    }
+
+    void Corrected_Row(const LD_Camera::Frame_View& my_Frame, int row,
+                       const Row_Corrections& row_Corrections, uint16_t* line){
+        if (my_Frame.bits_Per_Pixel > 8){
+            LD_Camera::Unpack_Mono16(my_Frame.Row(row), line, my_Frame.width, my_Frame.Shift());
+        }
+        else{
+            LD_Camera::Unpack_Mono8(my_Frame.Row(row), line, my_Frame.width);
+        }
+        // The replacements need the neighbours before anything is changed.
+        uint16_t replacements[16];
+        std::vector<uint16_t> more_Replacements;
+        uint16_t* replacement = replacements;
+        int n_Bad = row_Corrections.bad.last - row_Corrections.bad.first;
+        if (n_Bad > 16){
+            more_Replacements.resize(n_Bad);
+            replacement = more_Replacements.data();
+        }
+        for(int i=0; i < n_Bad; i++){
+            replacement[i] = Replacement(my_Frame, row, row_Corrections, row_Corrections.bad.first + i);
+        }
+
+        const uint16_t* subtract = row_Corrections.subtract;
+        if (subtract){
+            for(int col=0; col < my_Frame.width; col++){
+                line[col] = (line[col] > subtract[col]) ? (line[col] - subtract[col]) : 0;
+            }
+        }
+        for(int i=0; i < n_Bad; i++){
+            line[row_Corrections.bad.first[i] - row_Corrections.bad.offset] = replacement[i];
+        }
+    }
+
+    int Histogram_Row_Step(const LD_Camera::Frame_View& my_Frame){
+        return std::max(my_Frame.Num_Pixels() / histogram_Sample_Pixels, 1);
+    }
+
+    uint16_t Pick_Threshold(const Pixel_Histogram* histogram, double peak_Thresh,
+                            const Adaptive_Thresh& adaptive, Projection_Stats& stats){
+        if (!adaptive.enabled || !histogram || (histogram->n_Pixels == 0)){
+            stats.peak_Thresh = stats.max_Pixel * peak_Thresh;
+            stats.noise_Floor = abs_Thresh;
+        }
+        else{
+            // One standard deviation either side of the median is 15.87% of
+            // the pixels, for gaussian noise. Take the wider side, the dark
+            // side gets squashed up against 0 when a background has been
+            // taken off and the bright side has the spot in it, so both
+            // err on the high side. No narrower than a bin though.
+            int median = Percentile(*histogram, 0.5);
+            int low = Percentile(*histogram, 0.1587);
+            int high = Percentile(*histogram, 0.8413);
+            double sigma = std::max(std::max(median - low, high - median), 1 << histogram->bin_Shift);
+            stats.noise_Floor = std::min(median + (adaptive.noise_Sigmas * sigma), 65535.0);
+            stats.peak_Thresh = median + (std::max((int)stats.max_Pixel - median, 0) * peak_Thresh);
+        }
+        // A pixel has to beat both, so only the higher matters.
+        return std::max(stats.peak_Thresh, stats.noise_Floor);
+    }
+
+    void Background_Stats(const LD_Camera::Frame_View& my_Frame, const std::vector<uint16_t>& row_Max,
+                          const std::vector<Row_Sums>& row_Sums, uint16_t thresh, Projection_Stats& stats){
+        if (row_Sums.empty()){
+            return;
+        }
+        Row_Sums all = {0, 0, 0};
+        Row_Sums dark = {0, 0, 0};
+        int n_Dark_Rows = 0;
+        for(int row=0; row < my_Frame.height; row++){
+            all.total += row_Sums[row].total;
+            all.total_Squares += row_Sums[row].total_Squares;
+            all.n_Saturated += row_Sums[row].n_Saturated;
+            if (row_Max[row] <= thresh){
+                dark.total += row_Sums[row].total;
+                dark.total_Squares += row_Sums[row].total_Squares;
+                n_Dark_Rows++;
+            }
+        }
+        stats.n_Saturated = all.n_Saturated;
+        if (n_Dark_Rows == 0){
+            dark = all;
+            n_Dark_Rows = my_Frame.height;
+        }
+        double n_Pixels = (double)n_Dark_Rows * my_Frame.width;
+        double mean = dark.total / n_Pixels;
+        double variance = (dark.total_Squares / n_Pixels) - (mean * mean);
+        stats.background_Mean = mean;
+        // Can't know it any better than the rounding to whole counts.
+        stats.background_Noise = std::max(std::sqrt(std::max(variance, 0.0)), std::sqrt(1.0 / 12));
+    }
+
+    Projection_Stats Project_Reference(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                                       std::vector<uint64_t>& row_Totals,
+                                       std::vector<uint64_t>& col_Totals,
+                                       const Pixel_Corrections& corrections,
+                                       const Adaptive_Thresh& adaptive){
+        Reset_Totals(my_Frame, row_Totals, col_Totals);
+        if (!my_Frame.Valid()){
+            return {0, 0, 0, false, 0, 0, 0, 0};
+        }
+        Projection_Stats stats = {0, 0, 0, false, 0, 0, 0, 0};
+
+        // Get max value for the spot tracker. The spot tracker ignores
+        // pixels which are lower than some threshold to remove noise and
+        // any systematic illumination which adds up to being substantial
+        // when the rows/cols are summed. Read straight out of the frame a
+        // row at a time, corrected into line.
+        std::vector<uint16_t> line(my_Frame.width);
+        Pixel_Histogram histogram;
+        Reset_Histogram(histogram, my_Frame.bits_Per_Pixel);
+        int row_Step = Histogram_Row_Step(my_Frame);
+        // How good a spot it is. Saturation is of the raw pixels, but not
+        // the bad ones since they've been replaced.
+        uint16_t full_Scale = (1 << my_Frame.bits_Per_Pixel) - 1;
+        std::vector<uint16_t> row_Max(my_Frame.height);
+        std::vector<Row_Sums> row_Sums;
+        Reset_Row_Sums(my_Frame, true, row_Sums);
+        for(int row=0; row < my_Frame.height; row++){
+            Row_Corrections row_Corrections = Corrections_For_Row(corrections, my_Frame, row);
+            Corrected_Row(my_Frame, row, row_Corrections, line.data());
+            row_Max[row] = *std::max_element(line.begin(), line.end());
+            stats.max_Pixel = std::max(stats.max_Pixel, row_Max[row]);
+            LD_Camera::Bad_Columns bad = row_Corrections.bad;
+            for(int col=0; col < my_Frame.width; col++){
+                row_Sums[row].total += line[col];
+                row_Sums[row].total_Squares += (uint32_t)line[col] * line[col];
+                bool is_Bad = std::find(bad.first, bad.last, col + bad.offset) != bad.last;
+                row_Sums[row].n_Saturated += !is_Bad && (my_Frame.Pixel(col, row) == full_Scale);
+                if ((row % row_Step) == 0){
+                    histogram.counts[line[col] >> histogram.bin_Shift]++;
+                    histogram.n_Pixels++;
+                }
+            }
+        }
+        uint16_t thresh = Pick_Threshold(&histogram, peak_Thresh, adaptive, stats);
+        Background_Stats(my_Frame, row_Max, row_Sums, thresh, stats);
+
+        // Sum the pixels in each row and column. This is a projection of
+        // the image into 1D. For a laser spot this will result in a
+        // (roughly) gaussian - especially when the low valued pixels are
+        // ignored.
+        for(int row=0; row < my_Frame.height; row++){
+            Corrected_Row(my_Frame, row, Corrections_For_Row(corrections, my_Frame, row), line.data());
+            for(int col=0; col < my_Frame.width; col++){
+                uint16_t pixel = line[col];
+                // Try not to count noise.
+                if((pixel > stats.peak_Thresh) & (pixel > stats.noise_Floor)){
+                    row_Totals[row] += pixel;
+                    col_Totals[col] += pixel;
+                    stats.n_Peak_Pixels++;
+                }
+            }
+        }
+        return stats;
+    }
+
+    Projection_Stats Project_Fused(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                                   std::vector<uint64_t>& row_Totals,
+                                   std::vector<uint64_t>& col_Totals,
+                                   Projection_Scratch& scratch,
+                                   const Pixel_Corrections& corrections,
+                                   const Adaptive_Thresh& adaptive){
+        Reset_Totals(my_Frame, row_Totals, col_Totals);
+        if (!my_Frame.Valid()){
+            return {0, 0, 0, false, 0, 0, 0, 0};
+        }
+        Projection_Stats stats = {0, 0, 0, false, 0, 0, 0, 0};
+
+        // The one full sweep, counting the histogram too if it's wanted.
+        scratch.row_Max.resize(my_Frame.height);
+        Reset_Row_Sums(my_Frame, scratch.metrics, scratch.row_Sums);
+        Pixel_Histogram* histogram = nullptr;
+        if (adaptive.enabled){
+            Reset_Histogram(scratch.histogram, my_Frame.bits_Per_Pixel);
+            histogram = &scratch.histogram;
+        }
+        int row_Step = Histogram_Row_Step(my_Frame);
+        for(int row=0; row < my_Frame.height; row++){
+            scratch.row_Max[row] = Corrected_Row_Max(my_Frame, row, Corrections_For_Row(corrections, my_Frame, row),
+                                                     Sums_For_Row(scratch.row_Sums, row),
+                                                     (row % row_Step) ? nullptr : histogram);
+            stats.max_Pixel = std::max(stats.max_Pixel, scratch.row_Max[row]);
+        }
+        if (histogram){
+            Finish_Histogram(*histogram);
+        }
+
+        // A row with nothing above the threshold can't add anything to the
+        // projections, so don't bother reading it again.
+        uint16_t thresh = Pick_Threshold(histogram, peak_Thresh, adaptive, stats);
+        Background_Stats(my_Frame, scratch.row_Max, scratch.row_Sums, thresh, stats);
+        scratch.col_Acc.assign(my_Frame.width, 0);
+        stats.n_Peak_Pixels = Project_Bright_Rows(my_Frame, scratch.row_Max, thresh, 0, my_Frame.height,
+                                                  row_Totals, scratch.col_Acc, corrections);
+        std::copy(scratch.col_Acc.begin(), scratch.col_Acc.end(), col_Totals.begin());
+        return stats;
+    }
+
+    Projection_Stats Project_Predicted(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                                       uint16_t predicted_Max, double rescan_Fraction,
+                                       std::vector<uint64_t>& row_Totals,
+                                       std::vector<uint64_t>& col_Totals,
+                                       Projection_Scratch& scratch,
+                                       const Pixel_Corrections& corrections){
+        Reset_Totals(my_Frame, row_Totals, col_Totals);
+        if (!my_Frame.Valid()){
+            return {0, 0, 0, false, 0, 0, 0, 0};
+        }
+        Projection_Stats stats = {0, 0, 0, false, 0, 0, 0, 0};
+
+        // The one pass, against the threshold from the guess.
+        stats.peak_Thresh = predicted_Max * peak_Thresh;
+        stats.noise_Floor = abs_Thresh;
+        uint16_t thresh = std::max(stats.peak_Thresh, stats.noise_Floor);
+        scratch.row_Max.resize(my_Frame.height);
+        Reset_Row_Sums(my_Frame, scratch.metrics, scratch.row_Sums);
+        scratch.col_Acc.assign(my_Frame.width, 0);
+        stats.n_Peak_Pixels = Project_Predicted_Rows(my_Frame, scratch.row_Max, scratch.row_Sums,
+                                                     thresh, 0, my_Frame.height,
+                                                     stats.max_Pixel, row_Totals, scratch.col_Acc, corrections);
+
+        // Guessed wrong, start again from the real maximum. Still only the
+        // bright rows need reading again.
+        if (Prediction_Failed(stats.max_Pixel, predicted_Max, rescan_Fraction)){
+            stats.rescanned = true;
+            stats.peak_Thresh = stats.max_Pixel * peak_Thresh;
+            thresh = std::max(stats.peak_Thresh, stats.noise_Floor);
+            std::fill(row_Totals.begin(), row_Totals.end(), 0);
+            scratch.col_Acc.assign(my_Frame.width, 0);
+            stats.n_Peak_Pixels = Project_Bright_Rows(my_Frame, scratch.row_Max, thresh, 0, my_Frame.height,
+                                                      row_Totals, scratch.col_Acc, corrections);
+        }
+        Background_Stats(my_Frame, scratch.row_Max, scratch.row_Sums, thresh, stats);
+        std::copy(scratch.col_Acc.begin(), scratch.col_Acc.end(), col_Totals.begin());
+        return stats;
+    }
+
+    Projection_Stats Project_Fixed(const LD_Camera::Frame_View& my_Frame, double peak_Thresh,
+                                   std::vector<uint64_t>& row_Totals,
+                                   std::vector<uint64_t>& col_Totals,
+                                   Projection_Scratch& scratch,
+                                   const Pixel_Corrections& corrections,
+                                   const Adaptive_Thresh& adaptive){
+        const uint16_t* subtract = nullptr;
+        int subtract_Stride = 0;
+        if (!Fixed_Geometry(my_Frame) || adaptive.enabled ||
+            !Uniform_Corrections(my_Frame, corrections, subtract, subtract_Stride)){
+            return Project_Fused(my_Frame, peak_Thresh, row_Totals, col_Totals, scratch, corrections, adaptive);
+        }
+        Reset_Totals(my_Frame, row_Totals, col_Totals);
+        if (my_Frame.width == 128){
+            return Project_Fixed_T<128, 128>(my_Frame, peak_Thresh, row_Totals, col_Totals, scratch,
+                                             subtract, subtract_Stride);
+        }
+        else{
+            return Project_Fixed_T<256, 256>(my_Frame, peak_Thresh, row_Totals, col_Totals, scratch,
+                                             subtract, subtract_Stride);
+        }
+    }
+
+    bool Fixed_Geometry(const LD_Camera::Frame_View& my_Frame){
+        if (!my_Frame.Valid()){
+            return false;
+        }
+        return ((my_Frame.width == 128) && (my_Frame.height == 128)) ||
+               ((my_Frame.width == 256) && (my_Frame.height == 256));
+    }
+
+} // namespace LD_QuarcTracker
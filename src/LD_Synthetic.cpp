@@ -0,0 +1,85 @@
+#include "LD_Synthetic.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace LD_Camera{
+    namespace{
+        // Fraction of a 1D gaussian that lands on each pixel.
+        std::vector<double> Pixel_Fractions(int n_Pixels, double centre, double sigma){
+            std::vector<double> fractions(n_Pixels);
+            double scale = 1 / (sigma * std::sqrt(2.0));
+            for(int i=0; i < n_Pixels; i++){
+                fractions[i] = 0.5 * (std::erf((i + 0.5 - centre) * scale) - std::erf((i - 0.5 - centre) * scale));
+            }
+            return fractions;
+        }
+
+        // Poisson is slow to draw from and no different from a gaussian
+        // once there's this many electrons.
+        const double poisson_Max_Mean = 50;
+
+        const double pi = 3.14159265358979323846;
+    } // namespace
+
+    Synthetic_Options Default_Synthetic(int width, int height, int bits_Per_Pixel){
+        Synthetic_Options options;
+        options.width = width;
+        options.height = height;
+        options.bits_Per_Pixel = bits_Per_Pixel;
+        options.spot_X = width / 2.0;
+        options.spot_Y = height / 2.0;
+        options.sigma = 4;
+        // A 10 bit sensor with a full well of 10000 electrons or so.
+        int max_Value = (1 << bits_Per_Pixel) - 1;
+        options.gain = 10000.0 / max_Value;
+        options.peak_Electrons = 8000;
+        options.background_Electrons = 200;
+        options.gradient_X = 0.5;
+        options.gradient_Y = 0.25;
+        options.read_Noise = 20;
+        options.shot_Noise = true;
+        options.hot_Fraction = 1e-4;
+        options.hot_Max = max_Value / 4;
+        return options;
+    }
+
+    std::vector<uint16_t> Make_Synthetic_Frame(const Synthetic_Options& options, std::mt19937& random_Engine){
+        int max_Value = (1 << options.bits_Per_Pixel) - 1;
+        std::vector<double> x_Fractions = Pixel_Fractions(options.width, options.spot_X, options.sigma);
+        std::vector<double> y_Fractions = Pixel_Fractions(options.height, options.spot_Y, options.sigma);
+        // Electrons in the whole spot.
+        double spot_Total = options.peak_Electrons * 2 * pi * options.sigma * options.sigma;
+
+        std::normal_distribution<double> unit_Normal(0, 1);
+        std::vector<uint16_t> pixels(options.width * options.height);
+        for(int y=0; y < options.height; y++){
+            for(int x=0; x < options.width; x++){
+                double electrons = spot_Total * x_Fractions[x] * y_Fractions[y] + options.background_Electrons +
+                                   (options.gradient_X * x) + (options.gradient_Y * y);
+                electrons = std::max(electrons, 0.0);
+                if (options.shot_Noise){
+                    if (electrons < poisson_Max_Mean){
+                        electrons = std::poisson_distribution<int>(electrons)(random_Engine);
+                    }
+                    else{
+                        electrons += std::sqrt(electrons) * unit_Normal(random_Engine);
+                    }
+                }
+                electrons += options.read_Noise * unit_Normal(random_Engine);
+                double value = std::round(electrons / options.gain);
+                pixels[y * options.width + x] = std::min(std::max(value, 0.0), (double)max_Value);
+            }
+        }
+
+        int n_Hot = std::lround(options.hot_Fraction * pixels.size());
+        std::uniform_int_distribution<int> random_Pixel(0, pixels.size() - 1);
+        std::uniform_int_distribution<int> random_Extra(0, options.hot_Max);
+        for(int i=0; i < n_Hot; i++){
+            uint16_t& pixel = pixels[random_Pixel(random_Engine)];
+            pixel = std::min(pixel + random_Extra(random_Engine), max_Value);
+        }
+        return pixels;
+    }
+
+} // namespace LD_Camera
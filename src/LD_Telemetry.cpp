@@ -0,0 +1,188 @@
+#include "LD_Telemetry.h"
+#include "LD_Camera.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif // __linux
+
+namespace{
+    // Keep everything on its own cache lines.
+    uint32_t Round_Up(uint32_t bytes){
+        return (bytes + 63) & ~63u;
+    }
+
+    // How long since a reader last checked in before the pixels stop being
+    // copied.
+    const uint64_t reader_Timeout_Ns = 1000000000;
+
+    uint64_t Now_Ns(){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    #ifdef __linux
+    // Make (or reuse) a shared memory segment of bytes and map it.
+    uint8_t* Map_Segment(const std::string& name, size_t bytes, mode_t mode){
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, mode);
+        if (fd < 0){
+            std::cout << "Couldn't open shared memory " << name << "\n";
+            return nullptr;
+        }
+        // Whatever the umask took off.
+        fchmod(fd, mode);
+        if (ftruncate(fd, bytes) != 0){
+            std::cout << "Couldn't size shared memory " << name << " to " << bytes << " bytes" << "\n";
+            close(fd);
+            return nullptr;
+        }
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED){
+            std::cout << "Couldn't map shared memory " << name << "\n";
+            return nullptr;
+        }
+        return (uint8_t*)memory;
+    }
+    #endif // __linux
+} // namespace
+
+LD_Telemetry::LD_Telemetry()
+{
+
+}
+
+LD_Telemetry::~LD_Telemetry()
+{
+    Close();
+}
+
+int LD_Telemetry::Open(const std::string& name, int n_Slots, uint32_t max_Pixel_Bytes){
+    #ifdef __linux
+    Close();
+    if (n_Slots < 1){
+        std::cout << "Telemetry needs at least one slot, not " << n_Slots << "\n";
+        return 1;
+    }
+    uint32_t header_Bytes = Round_Up(sizeof(Telemetry_Header));
+    uint32_t record_Bytes = Round_Up(sizeof(Telemetry_Record));
+    uint32_t slot_Bytes = Round_Up(record_Bytes + max_Pixel_Bytes);
+    size_t bytes = header_Bytes + ((size_t)n_Slots * slot_Bytes);
+
+    // Readers can look but not touch.
+    segment = Map_Segment(name, bytes, 0644);
+    if (segment == nullptr){
+        return 1;
+    }
+    segment_Bytes = bytes;
+    segment_Name = name;
+    // Anyone can say they're reading.
+    readers = (std::atomic<uint64_t>*)Map_Segment(name + "_readers", sizeof(uint64_t), 0666);
+    if (readers == nullptr){
+        Close();
+        return 1;
+    }
+
+    // Zero the records so old sequence numbers from a previous run don't
+    // look valid, then fill the header in last, so a reader that finds the
+    // magic number finds the rest too.
+    std::memset(segment, 0, bytes);
+    header = (Telemetry_Header*)segment;
+    header->version = telemetry_Version;
+    header->n_Slots = n_Slots;
+    header->slot_Bytes = slot_Bytes;
+    header->header_Bytes = header_Bytes;
+    header->record_Bytes = record_Bytes;
+    header->max_Pixel_Bytes = max_Pixel_Bytes;
+    header->write_Count.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = telemetry_Magic;
+
+    std::cout << "Publishing telemetry to " << name << " (" << bytes << " bytes)" << "\n";
+    return 0;
+    #else
+    (void)name;
+    (void)n_Slots;
+    (void)max_Pixel_Bytes;
+    std::cout << "Shared memory telemetry is only supported on Linux" << "\n";
+    return 1;
+    #endif // __linux
+}
+
+int LD_Telemetry::Close(){
+    #ifdef __linux
+    if (readers != nullptr){
+        munmap((void*)readers, sizeof(uint64_t));
+        shm_unlink((segment_Name + "_readers").c_str());
+        readers = nullptr;
+    }
+    if (segment != nullptr){
+        munmap(segment, segment_Bytes);
+        shm_unlink(segment_Name.c_str());
+        segment = nullptr;
+        header = nullptr;
+    }
+    #endif // __linux
+    return 0;
+}
+
+bool LD_Telemetry::Is_Open(){
+    return header != nullptr;
+}
+
+bool LD_Telemetry::Reader_Subscribed(){
+    if (readers == nullptr){
+        return false;
+    }
+    uint64_t heartbeat = readers->load(std::memory_order_relaxed);
+    return (heartbeat != 0) && (Now_Ns() - heartbeat < reader_Timeout_Ns);
+}
+
+int LD_Telemetry::Publish(Telemetry_Values values, const LD_Camera::Frame_View& my_Frame){
+    if (header == nullptr){
+        return 1;
+    }
+    uint64_t step = header->write_Count.load(std::memory_order_relaxed);
+    uint8_t* slot = segment + header->header_Bytes + ((step % header->n_Slots) * header->slot_Bytes);
+    Telemetry_Record* record = (Telemetry_Record*)slot;
+
+    values.time_Ns = Now_Ns();
+    values.width = my_Frame.width;
+    values.height = my_Frame.height;
+    values.offset_X = my_Frame.offset_X;
+    values.offset_Y = my_Frame.offset_Y;
+    values.bits_Per_Pixel = my_Frame.bits_Per_Pixel;
+    uint32_t row_Bytes = my_Frame.width * my_Frame.Bytes_Per_Pixel();
+    values.pixel_Bytes = 0;
+    if (my_Frame.Valid() && Reader_Subscribed()){
+        values.pixel_Bytes = row_Bytes * my_Frame.height;
+        if (values.pixel_Bytes > header->max_Pixel_Bytes){
+            // Shouldn't happen, the biggest frame is known at Open.
+            values.pixel_Bytes = 0;
+        }
+    }
+
+    // Odd while writing.
+    uint64_t sequence = record->sequence.load(std::memory_order_relaxed);
+    record->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record->values = values;
+    uint8_t* pixels = slot + header->record_Bytes;
+    if (values.pixel_Bytes > 0){
+        LD_Camera::Count_Image_Copy();
+        for(int y=0; y < my_Frame.height; y++){
+            std::memcpy(pixels + (y * row_Bytes), my_Frame.Row(y), row_Bytes);
+        }
+    }
+
+    record->sequence.store(sequence + 2, std::memory_order_release);
+    header->write_Count.store(step + 1, std::memory_order_release);
+    return 0;
+}
@@ -6,26 +6,364 @@
 #include <iostream>
 
 namespace LD_QuarcTracker{
+    namespace{
+        // Fewer pixels than this over the threshold isn't a spot, it's noise
+        // (or a hot pixel).
+        const int min_Peak_Pixels = 5;
+
+        // Bytes of pixels in my_Frame, what one pass over it reads.
+        uint64_t Frame_Bytes(const LD_Camera::Frame_View& my_Frame){
+            if (!my_Frame.Valid()){
+                return 0;
+            }
+            return (uint64_t)my_Frame.Num_Pixels() * my_Frame.Bytes_Per_Pixel();
+        }
+    } // namespace
+
+    Spot_Estimator Estimator_From_Name(std::string name){
+        if (name == "gauss_fit"){
+            return ESTIMATOR_GAUSS_FIT;
+        }
+        if (name == "parabolic"){
+            return ESTIMATOR_PARABOLIC;
+        }
+        if (name == "gauss_3point"){
+            return ESTIMATOR_GAUSS_3POINT;
+        }
+        if (name == "windowed"){
+            return ESTIMATOR_WINDOWED;
+        }
+        if (name != "centroid"){
+            std::cout << "Unknown spot estimator " << name << ", using centroid" << "\n";
+        }
+        return ESTIMATOR_CENTROID;
+    }
+
+    std::string Spot_Failure_Name(Spot_Failure failure){
+        switch (failure){
+            case SPOT_OK:
+                return "ok";
+            case SPOT_NO_FRAME:
+                return "no_frame";
+            case SPOT_TOO_FAINT:
+                return "too_faint";
+            case SPOT_TOO_BIG:
+                return "too_big";
+            case SPOT_NO_BLOB:
+                return "no_blob";
+        }
+        return "unknown";
+    }
+
+    TrackerCamera::~TrackerCamera(){
+        Save_Backgrounds();
+    }
+
     int TrackerCamera::Set_SpotFinder_Options(SpotFinderOptions options){
         my_Options = options;
+
+        projection_Scratch.metrics = my_Options.spot_Metrics;
+
+        adaptive.enabled = my_Options.adaptive_Thresh;
+        adaptive.noise_Sigmas = my_Options.noise_Sigmas;
+        if (my_Options.adaptive_Thresh && my_Options.predict_Thresh){
+            std::cout << "Adaptive thresholds need the whole frame first, not predicting them" << "\n";
+        }
+        if (my_Options.sparse_Search && (Sparse_Stride(my_Options.sparse_Spot_Size) < sparse_Min_Stride)){
+            std::cout << "Sparse search is slower than the whole frame for a " << my_Options.sparse_Spot_Size
+                      << " pixel spot, not using it" << "\n";
+            my_Options.sparse_Search = false;
+        }
+        return 0;
+    }
+
+    Spot_Result TrackerCamera::Spot_Finder(LD_Camera::Subpixel_Values& spot_Coords){
+        return Spot_Finder(Get_Frame(), spot_Coords);
+    }
+
+    Spot_Result TrackerCamera::Spot_Finder(const LD_Camera::Frame_View& my_Frame,
+                                           LD_Camera::Subpixel_Values& spot_Coords){
+        last_Fit = Gauss_Fit_Result();
+        last_Blob_Count = 0;
+        frame_Stats = {0, 0, 0, false, 0, 0, 0, 0};
+        spot_Result = Spot_Result();
+        frame_Bytes_Read = 0;
+        frame_Corrections = Pixel_Corrections();
+        if (my_Options.background_Subtract && my_Frame.Valid()){
+            const Background_Model& background = Background_For(my_Frame);
+            if (background.Ready()){
+                frame_Corrections.background = &background;
+            }
+        }
+        if (my_Options.pixel_Map_Correct && !Get_Pixel_Map().Empty()){
+            frame_Corrections.pixel_Map = &Get_Pixel_Map();
+        }
+
+        bool spot_Found = false;
+        // Most of the time the spot is close to where it was last frame, so
+        // try there first. Much less to read than the whole frame.
+        if (my_Options.roi_Search && roi_Valid &&
+            Search_Window(my_Frame, ROI_Window(my_Frame), spot_Coords)){
+            spot_Found = true;
+        }
+        // Otherwise find roughly where it is from a few of the pixels or a
+        // shrunk copy of the frame, and only look properly around there.
+        else if (my_Options.sparse_Search &&
+                 Search_Window(my_Frame, Sparse_Window(my_Frame), spot_Coords)){
+            spot_Found = true;
+        }
+        else if (my_Options.pyramid_Search &&
+                 Search_Window(my_Frame, Pyramid_Window(my_Frame), spot_Coords)){
+            spot_Found = true;
+        }
+        else if (Find_Spot(my_Frame, spot_Coords, true)){
+            spot_Found = true;
+        }
+
+        if (spot_Found){
+            Update_ROI(my_Frame, spot_Coords);
+            spot_Seen = true;
+        }
+        else{
+            roi_Valid = false;
+        }
+        if (my_Options.background_Subtract){
+            Update_Background(my_Frame);
+        }
+        Fill_Spot_Result(spot_Found);
+        return spot_Result;
+    }
+
+    int TrackerCamera::Fill_Spot_Result(bool spot_Found){
+        spot_Result.found = spot_Found;
+        spot_Result.bytes_Read = frame_Bytes_Read;
+        if (spot_Found){
+            spot_Result.failure = SPOT_OK;
+        }
+        else{
+            spot_Result.width_X = 0;
+            spot_Result.width_Y = 0;
+            spot_Result.ellipticity = 0;
+        }
+        spot_Result.peak = frame_Stats.max_Pixel;
+        spot_Result.n_Saturated = frame_Stats.n_Saturated;
+        spot_Result.background = frame_Stats.background_Mean;
+        spot_Result.noise = frame_Stats.background_Noise;
+        spot_Result.n_Peak_Pixels = frame_Stats.n_Peak_Pixels;
+        spot_Result.threshold = std::max(frame_Stats.peak_Thresh, frame_Stats.noise_Floor);
+        spot_Result.noise_Floor = frame_Stats.noise_Floor;
+        spot_Result.snr = 0;
+        if (frame_Stats.background_Noise > 0){
+            spot_Result.snr = (frame_Stats.max_Pixel - frame_Stats.background_Mean) / frame_Stats.background_Noise;
+        }
+        return 0;
+    }
+
+    Background_Model& TrackerCamera::Background_For(const LD_Camera::Frame_View& my_Frame){
+        std::string name = Background_Model::Geometry_Name(my_Frame);
+        auto found = backgrounds.find(name);
+        if (found != backgrounds.end()){
+            return found->second;
+        }
+
+        Background_Model& background = backgrounds[name];
+        background.Reset(my_Frame);
+        background_Files[name] = Background_File(my_Frame);
+        // Warm start, if it's been saved before.
+        if (!my_Options.background_Path.empty()){
+            background.Load(background_Files[name]);
+        }
+        return background;
+    }
+
+    int TrackerCamera::Update_Background(const LD_Camera::Frame_View& my_Frame){
+        if (!my_Frame.Valid()){
+            return 1;
+        }
+        Background_Model& background = Background_For(my_Frame);
+        // Always learn the first frame, after that only every so often.
+        frames_Since_Background++;
+        if (background.Ready() && (frames_Since_Background < my_Options.background_Update_Period)){
+            return 0;
+        }
+        frames_Since_Background = 0;
+        frame_Bytes_Read += Frame_Bytes(my_Frame);
+
+        // Round the time constant to a power of 2 so the average is shifts.
+        int rate_Shift = std::lround(std::log2(std::max(my_Options.background_Frames, 1)));
+
+        // Leave the pixels round where the spot last was alone, it isn't
+        // background. (Even if it wasn't found this time, it's probably
+        // still near there)
+        int skip_Size = spot_Seen ? my_Options.background_Skip : 0;
+        int skip_X = std::lround(roi_Last_Spot.x - my_Frame.offset_X) - (skip_Size / 2);
+        int skip_Y = std::lround(roi_Last_Spot.y - my_Frame.offset_Y) - (skip_Size / 2);
+        return background.Update(my_Frame, rate_Shift, skip_X, skip_Y, skip_Size, skip_Size);
+    }
+
+    std::string TrackerCamera::Background_File(const LD_Camera::Frame_View& my_Frame){
+        return my_Options.background_Path + "/background_" + Background_Model::Geometry_Name(my_Frame) + ".dat";
+    }
+
+    int TrackerCamera::Save_Backgrounds(){
+        int n_Errors = 0;
+        for (auto& background : backgrounds){
+            if (!my_Options.background_Path.empty() && background.second.Ready()){
+                n_Errors += background.second.Save(background_Files[background.first]);
+            }
+        }
+        return n_Errors;
+    }
+
+    bool TrackerCamera::Search_Window(const LD_Camera::Frame_View& my_Frame,
+                                      const LD_Camera::Frame_View& window,
+                                      LD_Camera::Subpixel_Values& spot_Coords){
+        // No point if the window is the whole frame anyway.
+        if (!window.Valid() || (window.Num_Pixels() >= my_Frame.Num_Pixels())){
+            return false;
+        }
+        if (!Find_Spot(window, spot_Coords, false) || ROI_Clipped(my_Frame, window)){
+            return false;
+        }
+        // Back to co-ordinates in my_Frame.
+        spot_Coords.x += window.offset_X - my_Frame.offset_X;
+        spot_Coords.y += window.offset_Y - my_Frame.offset_Y;
+        my_Spot_Coords = spot_Coords;
+        return true;
+    }
+
+    LD_Camera::Frame_View TrackerCamera::Pyramid_Window(const LD_Camera::Frame_View& my_Frame){
+        int block_X;
+        int block_Y;
+        frame_Bytes_Read += Frame_Bytes(my_Frame);
+        if ((Build_Pyramid(my_Frame, my_Options.pyramid_Factor, pyramid_Image) != 0) ||
+            !Brightest_Block(pyramid_Image, block_X, block_Y)){
+            return LD_Camera::Frame_View();
+        }
+        int half_Window = my_Options.pyramid_Window / 2;
+        return my_Frame.Sub_View(block_X - half_Window, block_Y - half_Window,
+                                 my_Options.pyramid_Window, my_Options.pyramid_Window);
+    }
+
+    LD_Camera::Frame_View TrackerCamera::Sparse_Window(const LD_Camera::Frame_View& my_Frame){
+        if (my_Frame.Num_Pixels() < my_Options.sparse_Min_Pixels){
+            return LD_Camera::Frame_View();
+        }
+        if (Sample_Grid(my_Frame, Sparse_Stride(my_Options.sparse_Spot_Size), frame_Corrections, sparse_Grid) != 0){
+            return LD_Camera::Frame_View();
+        }
+        frame_Bytes_Read += sparse_Grid.bytes_Read;
+        int x;
+        int y;
+        int width;
+        int height;
+        if (!Candidate_Box(sparse_Grid, my_Options.peak_Thresh, abs_Thresh, x, y, width, height)){
+            return LD_Camera::Frame_View();
+        }
+        return my_Frame.Sub_View(x, y, width, height);
+    }
+
+    LD_Camera::Frame_View TrackerCamera::ROI_Window(const LD_Camera::Frame_View& my_Frame){
+        // Where the spot should be now, if it kept going at the same speed.
+        float frames_Since = 1;
+        if ((my_Frame.frame_ID > roi_Last_Frame_ID) && (roi_Last_Frame_ID > 0)){
+            frames_Since = my_Frame.frame_ID - roi_Last_Frame_ID;
+        }
+        float centre_X = roi_Last_Spot.x + (roi_Velocity.x * frames_Since) - my_Frame.offset_X;
+        float centre_Y = roi_Last_Spot.y + (roi_Velocity.y * frames_Since) - my_Frame.offset_Y;
+
+        // Give it more room the faster it goes, it's less predictable.
+        int width = my_Options.roi_Size + 2 * std::ceil(std::fabs(roi_Velocity.x * frames_Since));
+        int height = my_Options.roi_Size + 2 * std::ceil(std::fabs(roi_Velocity.y * frames_Since));
+
+        // Sub_View clips it to the frame.
+        return my_Frame.Sub_View(std::lround(centre_X - (width / 2)), std::lround(centre_Y - (height / 2)),
+                                 width, height);
+    }
+
+    bool TrackerCamera::ROI_Clipped(const LD_Camera::Frame_View& my_Frame,
+                                    const LD_Camera::Frame_View& roi_Frame){
+        // If any counted pixels are on the edge of the window (and that edge
+        // isn't the edge of the frame) some of the spot is probably outside
+        // it, so the centre would be dragged inwards.
+        int left = roi_Frame.offset_X - my_Frame.offset_X;
+        int top = roi_Frame.offset_Y - my_Frame.offset_Y;
+        bool on_Left;
+        bool on_Right;
+        bool on_Top;
+        bool on_Bottom;
+        if (my_Options.blob_Detection){
+            // Only the blob that was picked matters.
+            on_Left = (chosen_Blob.min_X == 0);
+            on_Right = (chosen_Blob.max_X == roi_Frame.width - 1);
+            on_Top = (chosen_Blob.min_Y == 0);
+            on_Bottom = (chosen_Blob.max_Y == roi_Frame.height - 1);
+        }
+        else{
+            on_Left = (col_Totals.front() > 0);
+            on_Right = (col_Totals.back() > 0);
+            on_Top = (row_Totals.front() > 0);
+            on_Bottom = (row_Totals.back() > 0);
+        }
+        bool clipped_Left = (left > 0) && on_Left;
+        bool clipped_Right = (left + roi_Frame.width < my_Frame.width) && on_Right;
+        bool clipped_Top = (top > 0) && on_Top;
+        bool clipped_Bottom = (top + roi_Frame.height < my_Frame.height) && on_Bottom;
+        return clipped_Left || clipped_Right || clipped_Top || clipped_Bottom;
+    }
+
+    int TrackerCamera::Update_ROI(const LD_Camera::Frame_View& my_Frame,
+                                  LD_Camera::Subpixel_Values spot_Coords){
+        LD_Camera::Subpixel_Values sensor_Coords = {spot_Coords.x + my_Frame.offset_X,
+                                                    spot_Coords.y + my_Frame.offset_Y};
+        if (roi_Valid){
+            float frames_Since = 1;
+            if ((my_Frame.frame_ID > roi_Last_Frame_ID) && (roi_Last_Frame_ID > 0)){
+                frames_Since = my_Frame.frame_ID - roi_Last_Frame_ID;
+            }
+            roi_Velocity.x = (sensor_Coords.x - roi_Last_Spot.x) / frames_Since;
+            roi_Velocity.y = (sensor_Coords.y - roi_Last_Spot.y) / frames_Since;
+        }
+        else{
+            roi_Velocity = {0, 0};
+        }
+        roi_Last_Spot = sensor_Coords;
+        roi_Last_Frame_ID = my_Frame.frame_ID;
+        roi_Valid = true;
         return 0;
     }
 
-    bool TrackerCamera::Spot_Finder(LD_Camera::Subpixel_Values& spot_Coords){
+    bool TrackerCamera::Find_Spot(const LD_Camera::Frame_View& my_Frame,
+                                  LD_Camera::Subpixel_Values& spot_Coords, bool report_Errors){
+        if (!my_Frame.Valid()){
+            if (report_Errors){
+                std::cout << "Error no frame to find the spot in" << "\n";
+            }
+            spot_Result.failure = SPOT_NO_FRAME;
+            spot_Coords = {-1, -1};
+            return false;
+        }
+        if (my_Options.blob_Detection){
+            return Find_Blob_Spot(my_Frame, spot_Coords, report_Errors);
+        }
+
         // Project the image on the X and Y axes, this should look like two
         // gaussians (ish) if there is a single gaussian spot in the image
         // and n_Peak_Pixels will be relatively small (ie few bright pixels)
-        int n_Peak_Pixels = Project_Image_XY();
+        int n_Peak_Pixels = Project_Image_XY(my_Frame);
         //std::cout << n_Peak_Pixels << " pixels above 50% brightness" << std::endl;
 
         // Figure out whether it looks like there is a peak in the data. The
         // expectation is that there won't be a very high proportion of the
         // pixels higher than the threshold considered for noise (since the
         // spot is a spot and not a massive blob.
-        uint16_t min_Peak_Pixels = 5;
         if ((n_Peak_Pixels > my_Options.n_Peak_Pixels) |
             (n_Peak_Pixels < min_Peak_Pixels)){
-            std::cout << "Error " << n_Peak_Pixels << " pixels above threshold, that's too many" << "\n";
+            spot_Result.failure = (n_Peak_Pixels > my_Options.n_Peak_Pixels) ? SPOT_TOO_BIG : SPOT_TOO_FAINT;
+            if (report_Errors){
+                std::cout << "Error " << n_Peak_Pixels << " pixels above threshold, that's too "
+                          << ((spot_Result.failure == SPOT_TOO_BIG) ? "many" : "few") << "\n";
+            }
             // Try and make it obvious this is an invalid value (better than
             // not updating the value if the spot isn't found)
             spot_Coords = {-1, -1};
@@ -40,208 +378,224 @@ namespace LD_QuarcTracker{
         }
 
         // Sum of the rows is the projection in Y.
-        spot_Coords.y = Weighted_Average(row_Totals);
+        spot_Coords.y = Projection_Peak(row_Totals);
 
         // Sum of the cols is the projection in X.
-        spot_Coords.x = Weighted_Average(col_Totals);
+        spot_Coords.x = Projection_Peak(col_Totals);
+
+        // And how spread out they are, for the logs.
+        spot_Result.width_X = Weighted_Spread(col_Totals, spot_Coords.x);
+        spot_Result.width_Y = Weighted_Spread(row_Totals, spot_Coords.y);
+        float major = std::max(spot_Result.width_X, spot_Result.width_Y);
+        float minor = std::min(spot_Result.width_X, spot_Result.width_Y);
+        spot_Result.ellipticity = (major > 0) ? (1 - (minor / major)) : 0;
+
+        if (my_Options.estimator == ESTIMATOR_GAUSS_FIT){
+            Gauss_Fit_Spot(my_Frame, spot_Coords);
+        }
 
         my_Spot_Coords = spot_Coords;
         // Spot was found.
         return true;
     }
 
-    int TrackerCamera::Project_Image_XY(){
-        // Find the size of the current frame (it's referred to as an AOI but
-        // it could be the full frame, AOI is just a useful container for the
-        // information. This allows the spot finder to interpret the image
-        // buffer.
-        LD_Camera::AOI my_AOI;
-
-        // Look at the correct image data from the camera.
-        if(aoi_Set){
-            my_AOI = Get_AOI_Info();
-            image_Buffer = aoi_Image_Data;
+    int TrackerCamera::Project_Image_XY(const LD_Camera::Frame_View& my_Frame){
+        // The frame knows its own size (it might be the full frame or the AOI)
+        // which allows the spot finder to interpret the image buffer. The
+        // pixels are read straight out of the driver's memory, in whatever
+        // format it left them.
+        Projection_Stats stats;
+        // The fused kernels read the frame once (twice if they rescan), the
+        // reference one twice.
+        frame_Bytes_Read += Frame_Bytes(my_Frame) * (my_Options.fused_Kernel ? 1 : 2);
+        if (my_Options.fused_Kernel && my_Options.predict_Thresh && !adaptive.enabled){
+            stats = Project_Predicted(my_Frame, my_Options.peak_Thresh,
+                                      last_Max_Pixel, my_Options.rescan_Fraction,
+                                      row_Totals, col_Totals, projection_Scratch,
+                                      frame_Corrections);
+            if (stats.rescanned){
+                threshold_Rescans++;
+                frame_Bytes_Read += Frame_Bytes(my_Frame);
+            }
+        }
+        else if (my_Options.fused_Kernel && my_Options.fixed_Kernels){
+            stats = Project_Fixed(my_Frame, my_Options.peak_Thresh,
+                                  row_Totals, col_Totals, projection_Scratch,
+                                  frame_Corrections, adaptive);
+        }
+        else if (my_Options.fused_Kernel){
+            stats = Project_Fused(my_Frame, my_Options.peak_Thresh,
+                                  row_Totals, col_Totals, projection_Scratch,
+                                  frame_Corrections, adaptive);
         }
         else{
-            my_AOI = Get_Sensor_Size();
-            image_Buffer = full_Image_Data;
-        }
-
-        // Make sure the containers are the right size and set to zeros.
-        if (row_Totals.size() != (unsigned int)my_AOI.aoi_Size.s32Height){
-            row_Totals.resize(my_AOI.aoi_Size.s32Height);
-        }
-        std::fill(row_Totals.begin(), row_Totals.end(), 0);
-        if (col_Totals.size() != (unsigned int)my_AOI.aoi_Size.s32Width){
-            col_Totals.resize(my_AOI.aoi_Size.s32Width);
-        }
-        std::fill(col_Totals.begin(), col_Totals.end(), 0);
-
-        // Get max value for the spot tracker. The spot tracker ignores pixels
-        // which are lower than some threshold to remove noise and any
-        // systematic illumination which adds up to being substantial when the
-        // rows/cols are summed.
-        uint16_t max_Pixel = *std::max_element(image_Buffer.begin(), image_Buffer.end());
-        uint16_t peak_Thresh = max_Pixel * my_Options.peak_Thresh;
-        uint16_t abs_Thresh = 50;
-
-        // Sum the pixels in each row and column. This is a projection of
-        // the image into 1D. For a laser spot this will result in a (roughly)
-        // gaussian - especially when the low valued pixels are ignored.
-        int row;
-        int col;
-        int numCols = my_AOI.aoi_Size.s32Width;
-        int x = 0;
-        int n_Peak_Pixels = 0;
-        for(auto pixel : image_Buffer){
-            // Try not to count noise.
-            if((pixel > peak_Thresh) & (pixel > abs_Thresh)){
-                // I'm quite proud of this short cut.
-                row = std::floor(x / numCols);
-                col = x % numCols;
-
-                row_Totals[row] += pixel;
-                col_Totals[col] += pixel;
-                n_Peak_Pixels++;
+            stats = Project_Reference(my_Frame, my_Options.peak_Thresh,
+                                      row_Totals, col_Totals, frame_Corrections, adaptive);
+        }
+
+        // Check the fast version against the straightforward one. Slow!
+        if (my_Options.validate_Kernel && my_Options.fused_Kernel){
+            std::vector<uint64_t> reference_Rows;
+            std::vector<uint64_t> reference_Cols;
+            frame_Bytes_Read += 2 * Frame_Bytes(my_Frame);
+            Projection_Stats reference_Stats = Project_Reference(my_Frame, my_Options.peak_Thresh,
+                                                                 reference_Rows, reference_Cols,
+                                                                 frame_Corrections, adaptive);
+            // A predicted threshold that was close enough not to rescan
+            // can legitimately count a slightly different set of pixels.
+            bool same_Thresh = (reference_Stats.peak_Thresh == stats.peak_Thresh) &&
+                               (reference_Stats.noise_Floor == stats.noise_Floor);
+            if ((reference_Stats.max_Pixel != stats.max_Pixel) ||
+                (same_Thresh && ((reference_Stats.n_Peak_Pixels != stats.n_Peak_Pixels) ||
+                                 (reference_Rows != row_Totals) ||
+                                 (reference_Cols != col_Totals)))){
+                std::cout << "Fused kernel disagrees with reference on frame "
+                          << my_Frame.frame_ID << "\n";
             }
-            // Even using a ranged for, still need to keep track of element
-            // number :(
-            x++;
         }
 
-        return n_Peak_Pixels;
+        last_Max_Pixel = stats.max_Pixel;
+        frame_Stats = stats;
+        return stats.n_Peak_Pixels;
+    }
+
+    uint64_t TrackerCamera::Get_Threshold_Rescans(){
+        return threshold_Rescans;
     }
 
     float TrackerCamera::Weighted_Average(std::vector<uint64_t> &distribution){
+        return Thresholded_Centroid(distribution, my_Options.gaussian_Thresh);
+    }
+
+    float TrackerCamera::Projection_Peak(std::vector<uint64_t> &distribution){
+        switch (my_Options.estimator){
+            case ESTIMATOR_PARABOLIC:
+                return Parabolic_Peak(distribution);
+            case ESTIMATOR_GAUSS_3POINT:
+                return Gaussian_Peak(distribution);
+            case ESTIMATOR_WINDOWED:
+                return Windowed_Centroid(distribution, my_Options.window_Half_Width);
+            case ESTIMATOR_CENTROID:
+            case ESTIMATOR_GAUSS_FIT:
+                break;
+        }
+        return Weighted_Average(distribution);
+    }
+
+    float TrackerCamera::Weighted_Spread(const std::vector<uint64_t>& distribution, float mean){
+        // Same cut as Weighted_Average, so it's the spread of what the
+        // centre came from.
         uint64_t distribution_Max = *std::max_element(distribution.begin(), distribution.end());
         uint64_t gaussian_Thresh = distribution_Max * my_Options.gaussian_Thresh;
 
-        int i = 0;
-        uint64_t running_Total = 0;
+        double running_Total = 0;
         uint64_t running_Weights = 0;
-        for(auto pixel : distribution){
-            if (pixel > gaussian_Thresh){
-                // Only consider significantly big enough values to make sure
-                // low level noise is not skewing the result
-                running_Total += (i * pixel);
-                running_Weights += pixel;
+        for(unsigned int i=0; i < distribution.size(); i++){
+            if (distribution[i] > gaussian_Thresh){
+                double distance = i - mean;
+                running_Total += distance * distance * distribution[i];
+                running_Weights += distribution[i];
             }
-            i++;
         }
-        // The centre of the distribution to subpixel accuracy.
-        return ((float)running_Total) / ((float)running_Weights);
+        if (running_Weights == 0){
+            return 0;
+        }
+        return std::sqrt(running_Total / running_Weights);
     }
 
-    int TrackerCamera::Save_Projections(){
-        std::ofstream rows_Out("rows_Out.csv");
-        for(auto row : row_Totals){
-            rows_Out << row << "\n";
-        }
-        rows_Out.close();
+    bool TrackerCamera::Find_Blob_Spot(const LD_Camera::Frame_View& my_Frame,
+                                       LD_Camera::Subpixel_Values& spot_Coords, bool report_Errors){
+        frame_Bytes_Read += Frame_Bytes(my_Frame);
+        Find_Blobs(my_Frame, my_Options.peak_Thresh, blobs, blob_Scratch, frame_Corrections, &frame_Stats, adaptive);
+        last_Blob_Count = blobs.size();
 
-        std::ofstream cols_Out("cols_Out.csv");
-        for(auto col : col_Totals){
-            cols_Out << col << "\n";
+        // Where the spot was last time, in this frame's co-ordinates.
+        double last_X = roi_Last_Spot.x - my_Frame.offset_X;
+        double last_Y = roi_Last_Spot.y - my_Frame.offset_Y;
+        int chosen = Choose_Blob(blobs, my_Options.blob_Ranking, min_Peak_Pixels, my_Options.n_Peak_Pixels,
+                                 roi_Valid, last_X, last_Y, my_Options.blob_Expected_Area);
+        if (chosen < 0){
+            spot_Result.failure = blobs.empty() ? SPOT_TOO_FAINT : SPOT_NO_BLOB;
+            if (report_Errors){
+                std::cout << "Error none of the " << blobs.size() << " blobs look like the spot" << "\n";
+            }
+            spot_Coords = {-1, -1};
+            return false;
         }
-        cols_Out.close();
-        std::cout << "Spots saved" << "\n";
+        chosen_Blob = blobs[chosen];
 
-        return 0;
-    }
+        spot_Coords.x = chosen_Blob.x;
+        spot_Coords.y = chosen_Blob.y;
 
-    #ifdef HAVE_OPENCV
-    int TrackerCamera::Make_Opencv_Mat(LD_Camera::AOI my_AOI){
-        // Make a mat that looks a lot like the vector we had in the first
-        // place. (but 2d!). Easiest to make it B&W then convert to colour.
-        myMat = cv::Mat(my_AOI.aoi_Size.s32Height,
-                        my_AOI.aoi_Size.s32Width,
-                        CV_16UC1,
-                        image_Buffer.data()).clone();
-        // Display doesn't like 16 bit images, convert to 8 bit.
-        myMat.convertTo(myMat, CV_8UC1);
-        // Add some colour channels so we can draw on the image in colour.
-        cv::cvtColor(myMat, myMat, cv::COLOR_GRAY2BGR);
-        return 0;
+        // The blob has the full second moments, so the ellipse can be at
+        // any angle. Its axes are the eigenvalues of the covariance.
+        spot_Result.width_X = std::sqrt(std::max(chosen_Blob.var_X, 0.0));
+        spot_Result.width_Y = std::sqrt(std::max(chosen_Blob.var_Y, 0.0));
+        double mean_Var = (chosen_Blob.var_X + chosen_Blob.var_Y) / 2;
+        double half_Diff = (chosen_Blob.var_X - chosen_Blob.var_Y) / 2;
+        double radius = std::sqrt((half_Diff * half_Diff) + (chosen_Blob.cov_XY * chosen_Blob.cov_XY));
+        double major = mean_Var + radius;
+        double minor = std::max(mean_Var - radius, 0.0);
+        spot_Result.ellipticity = (major > 0) ? (1 - std::sqrt(minor / major)) : 0;
+        if (my_Options.estimator == ESTIMATOR_GAUSS_FIT){
+            Gauss_Fit_Spot(my_Frame, spot_Coords);
+        }
+        my_Spot_Coords = spot_Coords;
+        return true;
     }
 
-    int TrackerCamera::Display_Mat(){
-        // Display the image and return the key that was pressed while the
-        // image was displayed.
-        cv::imshow("hello", myMat);
-        return cv::waitKey(1);
+    int TrackerCamera::Get_Blob_Count(){
+        return last_Blob_Count;
     }
 
-    int TrackerCamera::Draw_Spot(LD_Camera::Subpixel_Values spot_Position, cv::Scalar colour){
-        // Draw a spot on the currently stored mat containing the camera image.
-        cv::Point spot_Centre((int)spot_Position.x, (int)spot_Position.y);
-        cv::circle(myMat, spot_Centre, 15, colour, 2, 8, 0);
-        return 0;
-    }
+    int TrackerCamera::Gauss_Fit_Spot(const LD_Camera::Frame_View& my_Frame,
+                                      LD_Camera::Subpixel_Values& spot_Coords){
+        int half_Window = my_Options.fit_Window / 2;
+        LD_Camera::Frame_View window = my_Frame.Sub_View(std::lround(spot_Coords.x) - half_Window,
+                                                         std::lround(spot_Coords.y) - half_Window,
+                                                         my_Options.fit_Window, my_Options.fit_Window);
+        if (!window.Valid()){
+            return 1;
+        }
+        // Window co-ordinates from here.
+        double seed_X = spot_Coords.x - (window.offset_X - my_Frame.offset_X);
+        double seed_Y = spot_Coords.y - (window.offset_Y - my_Frame.offset_Y);
+        frame_Bytes_Read += Frame_Bytes(window);
+        Gauss_Params seed = Seed_Gaussian(window, seed_X, seed_Y, fit_Scratch);
+        last_Fit = Fit_Gaussian(window, seed, my_Options.fit_Max_Iterations, fit_Scratch);
 
-    int TrackerCamera::Draw_AOI(LD_Camera::AOI my_AOI){
-        // Draw a rectangle corresponding to the AOI position in the full
-        // frame.
-        cv::Point top_Left(my_AOI.aoi_Position.s32X,
-                           my_AOI.aoi_Position.s32Y);
-        cv::Point bottom_Right (my_AOI.aoi_Position.s32X + my_AOI.aoi_Size.s32Width,
-                                my_AOI.aoi_Position.s32Y + my_AOI.aoi_Size.s32Height);
-        cv::rectangle(myMat, top_Left, bottom_Right, {255,0,0} , 2, 8, 0);
+        // A centre outside the window, or a long way from where the
+        // projections put it, means it's fitted something silly. Stick with
+        // the projections.
+        Gauss_Params& fit = last_Fit.params;
+        if ((fit.x0 < 0) || (fit.x0 > window.width - 1) ||
+            (fit.y0 < 0) || (fit.y0 > window.height - 1) ||
+            !Fit_Believable(last_Fit, seed)){
+            return 1;
+        }
+        spot_Coords.x = fit.x0 + (window.offset_X - my_Frame.offset_X);
+        spot_Coords.y = fit.y0 + (window.offset_Y - my_Frame.offset_Y);
         return 0;
     }
 
-    int TrackerCamera::Show_Image(int display_Mode){
-        // display modes:
-        // 0: just show the image.
-        // 1: draw a circle around the detected spot
-        // 2: also draw a circle at the set point
-        // 3: also draw a rectagle at the AOI (if not set)
-
-        // TODO: This is actually a call to the camera API, check the
-        // performance implications of this.
-        LD_Camera::AOI current_AOI = Get_Active_Frame_Info();
+    Gauss_Fit_Result TrackerCamera::Get_Last_Fit(){
+        return last_Fit;
+    }
 
-        if(aoi_Set){
-            image_Buffer = aoi_Image_Data;
+    int TrackerCamera::Save_Projections(){
+        std::ofstream rows_Out("rows_Out.csv");
+        for(auto row : row_Totals){
+            rows_Out << row << "\n";
         }
-        else{
-            image_Buffer = full_Image_Data;
-        }
-
-        // Need an opencv mat to pass to cv::imshow
-        Make_Opencv_Mat(current_AOI);
-
-        switch (display_Mode){
-            // Note that this falls through all the way down. (hence the
-            // reverse order of the cases)
-            case 3:
-                if(aoi_Set == false){
-                    Draw_AOI(Get_AOI_Info());
-                }
-                [[fallthrough]];
-            case 2:
-                if (aoi_Set){
-                    Draw_Spot({
-                        ((float)current_AOI.aoi_Size.s32Width/2),
-                        ((float)current_AOI.aoi_Size.s32Height/2)
-                        }, {0, 255, 0});
-                }
-                else{
-                    Draw_Spot({
-                        current_AOI.aoi_Position.s32X + ((float)current_AOI.aoi_Size.s32Width/2),
-                        current_AOI.aoi_Position.s32Y + ((float)current_AOI.aoi_Size.s32Height/2)
-                        }, {0,255,0});
-                }
-                [[fallthrough]];
-            case 1:
-                Draw_Spot(my_Spot_Coords, {0,0,255});
-                [[fallthrough]];
-            case 0:
-                // Just display the image with nothing else.
-                break;
+        rows_Out.close();
 
+        std::ofstream cols_Out("cols_Out.csv");
+        for(auto col : col_Totals){
+            cols_Out << col << "\n";
         }
+        cols_Out.close();
+        std::cout << "Spots saved" << "\n";
 
-        return Display_Mat();
+        return 0;
     }
-    #endif // HAVE_OPENCV
-}
+} // namespace LD_QuarcTracker
@@ -0,0 +1,111 @@
+import mmap
+import struct
+import sys
+import time
+
+import numpy as np
+
+# Reference reader for the tracker's shared memory telemetry (see
+# include/LD_Telemetry.h for the layout). Set Telemetry_Name in
+# GeneralSettings.ini to turn it on in the tracker.
+
+HEADER_FORMAT = "<8IQ"
+RECORD_FORMAT = "<QQQQ5iII6f"
+TELEMETRY_MAGIC = 0x54514C44
+TELEMETRY_VERSION = 1
+
+SPOT_FOUND = 1
+TRACKER_ON = 2
+AOI_SET = 4
+
+
+class TelemetryReader:
+
+    def __init__(self, name="/ld_quarctracker"):
+        # POSIX shared memory lives in /dev/shm on Linux.
+        segment_File = open("/dev/shm" + name, "rb")
+        self.segment = mmap.mmap(segment_File.fileno(), 0, access=mmap.ACCESS_READ)
+        segment_File.close()
+
+        (magic, version, self.n_Slots, self.slot_Bytes, self.header_Bytes,
+         self.record_Bytes, self.max_Pixel_Bytes, _, _) = struct.unpack_from(HEADER_FORMAT, self.segment, 0)
+        if magic != TELEMETRY_MAGIC or version != TELEMETRY_VERSION:
+            raise RuntimeError(f"{name} isn't version {TELEMETRY_VERSION} tracker telemetry")
+
+        # The only thing readers write: when they last looked, so the
+        # tracker knows to copy the pixels.
+        readers_File = open("/dev/shm" + name + "_readers", "r+b")
+        self.readers = mmap.mmap(readers_File.fileno(), 8)
+        readers_File.close()
+
+    def Heartbeat(self):
+        # Same clock as the tracker's std::chrono::steady_clock.
+        struct.pack_into("<Q", self.readers, 0, time.monotonic_ns())
+
+    def Write_Count(self):
+        return struct.unpack_from("<Q", self.segment, struct.calcsize(HEADER_FORMAT) - 8)[0]
+
+    def Read_Latest(self, retries=10):
+        # Returns (values dict, pixels or None), or None if nothing's been
+        # published or every try was overwritten mid copy.
+        self.Heartbeat()
+        for _ in range(retries):
+            write_Count = self.Write_Count()
+            if write_Count == 0:
+                return None
+            slot = self.header_Bytes + ((write_Count - 1) % self.n_Slots) * self.slot_Bytes
+
+            # Seqlock: odd means the tracker's writing it, and if it changed
+            # while copying the copy is no good.
+            sequence = struct.unpack_from("<Q", self.segment, slot)[0]
+            if sequence % 2:
+                continue
+            fields = struct.unpack_from(RECORD_FORMAT, self.segment, slot)
+            pixel_Bytes = fields[9]
+            pixels = self.segment[slot + self.record_Bytes:slot + self.record_Bytes + pixel_Bytes]
+            if struct.unpack_from("<Q", self.segment, slot)[0] != sequence:
+                continue
+
+            (_, step_Number, frame_ID, time_Ns, width, height, offset_X, offset_Y,
+             bits_Per_Pixel, pixel_Bytes, flags, spot_X, spot_Y, error_X, error_Y,
+             mirror_X, mirror_Y) = fields
+            values = {
+                "step": step_Number,
+                "frame_ID": frame_ID,
+                "time_Ns": time_Ns,
+                "width": width,
+                "height": height,
+                "offset_X": offset_X,
+                "offset_Y": offset_Y,
+                "bits_Per_Pixel": bits_Per_Pixel,
+                "spot_Found": bool(flags & SPOT_FOUND),
+                "tracker_On": bool(flags & TRACKER_ON),
+                "aoi_Set": bool(flags & AOI_SET),
+                "spot": (spot_X, spot_Y),
+                "error": (error_X, error_Y),
+                "mirror": (mirror_X, mirror_Y),
+            }
+            image = None
+            if pixel_Bytes > 0:
+                if bits_Per_Pixel > 8:
+                    # MONO16 has the value in the top bits.
+                    image = np.frombuffer(pixels, dtype="<u2").reshape((height, width)) >> (16 - bits_Per_Pixel)
+                else:
+                    image = np.frombuffer(pixels, dtype=np.uint8).reshape((height, width))
+            return values, image
+        return None
+
+
+def Print_Test(name):
+    reader = TelemetryReader(name)
+    while True:
+        latest = reader.Read_Latest()
+        if latest is not None:
+            values, image = latest
+            print(values["step"], values["spot"], values["error"], values["mirror"],
+                  "no image" if image is None else image.shape)
+        time.sleep(0.1)
+
+
+if __name__ == "__main__":
+    Print_Test(sys.argv[1] if len(sys.argv) > 1 else "/ld_quarctracker")